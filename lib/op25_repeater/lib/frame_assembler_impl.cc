@@ -135,9 +135,7 @@ namespace gr {
                 const uint8_t *in = (const uint8_t *) input_items[0];
 
                 if (d_sync) {
-                    for (int i=0; i<ninput_items[0]; i++) {
-                        d_sync->rx_sym(in[i]);
-                    }
+                    d_sync->rx_syms(in, ninput_items[0]);
                 }
         
         int amt_produce = 0;
@@ -178,11 +176,7 @@ namespace gr {
         if (terminated) {
             add_item_tag(0, nitems_written(0), pmt::intern("terminate"), pmt::from_long(1), pmt::intern(name()));
         }*/
-          for (int i = 0; i < output_queue[slot_id].size(); i++) {
-              //BOOST_LOG_TRIVIAL(info) << output_queue[slot_id][i];
-            out[i] = output_queue[slot_id][i];
-          }
-          output_queue[slot_id].clear();
+          output_queue[slot_id].pop_front(out, output_queue[slot_id].size());
           //output_queue[slot_id].erase(output_queue[slot_id].begin(), output_queue[slot_id].begin() + output_queue[slot_id].size());
         }
 
@@ -29,6 +29,7 @@
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <deque>
+#include "sample_ring.h"
 #include <array>
 #include "rx_base.h"
 #include "log_ts.h"
@@ -44,8 +45,8 @@ namespace gr {
                 int d_debug;
                 int d_msgq_id;
                 gr::msg_queue::sptr d_msg_queue;
-                //std::deque<int16_t> output_queue[2];
-                std::array<std::deque<int16_t>, 2> output_queue;
+                //sample_ring<int16_t> output_queue[2];
+                std::array<sample_ring<int16_t>, 2> output_queue;
                 rx_base* d_sync;
 
                 // internal functions
@@ -222,15 +222,12 @@ p25_frame_assembler_impl::general_work (int noutput_items,
 
         if (amt_produce > 0) {
             if (amt_produce >= 32768) {
-              BOOST_LOG_TRIVIAL(error) << "P25 Frame Assembler -  output_queue size: " << output_queue.size() << " max size: " << output_queue.max_size() << " limiting amt_produce to  32767 ";
+              BOOST_LOG_TRIVIAL(error) << "P25 Frame Assembler -  output_queue size: " << output_queue.size() << " capacity: " << output_queue.capacity() << " limiting amt_produce to  32767 ";
               
               amt_produce = 32767; // buffer limit is 32768, see gnuradio/gnuradio-runtime/lib/../include/gnuradio/buffer.h:186
             }
 
-            for (int i = 0; i < amt_produce; i++) {
-              out[i] = output_queue[i];
-            }
-            output_queue.erase(output_queue.begin(), output_queue.begin() + amt_produce);
+            output_queue.pop_front(out, amt_produce);
 
             send_grp_src_id();
 
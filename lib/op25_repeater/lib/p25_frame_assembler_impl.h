@@ -29,6 +29,7 @@
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <deque>
+#include "sample_ring.h"
 #include <boost/log/trivial.hpp>
 
 #include "p25p1_fdma.h"
@@ -70,7 +71,7 @@ namespace gr {
     void set_debug(int debug) ;
     void reset_timer() ;
 	typedef std::vector<bool> bit_vector;
-	std::deque<int16_t> output_queue;
+	sample_ring<int16_t> output_queue;
 
   void p25p2_queue_msg(int duid);
   void set_phase2_tdma(bool p);
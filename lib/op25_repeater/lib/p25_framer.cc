@@ -191,6 +191,33 @@ bool p25_framer::rx_sym(uint8_t dibit) {
     return rc;
 }
 
+/*
+ * hunt_sync: fast path for rx_sym() while no frame is in progress
+ * Outside a frame rx_sym() only shifts each dibit into nid_accum and checks
+ * for frame sync, so do exactly that in a tight loop.
+ *
+ * Returns the number of symbols consumed. Stops after the symbol that
+ * completes a frame sync, or returns 0 if a frame is in progress, after
+ * which the caller continues with rx_sym().
+ */
+int p25_framer::hunt_sync(const uint8_t *syms, int nsyms) {
+    if ((nid_syms > 0) || (next_bit > 0))
+        return 0;
+
+    uint64_t accum = nid_accum;
+    int i = 0;
+    while (i < nsyms) {
+        accum = (accum << 2) | syms[i++];
+        if (check_frame_sync((accum & P25_FRAME_SYNC_MASK) ^ P25_FRAME_SYNC_MAGIC, 6, 48)) {
+            nid_syms = 1;
+            break;
+        }
+    }
+    nid_accum = accum;
+    symbols_received += i;
+    return i;
+}
+
 /*
  * load_nid: called by framer when SYNC + NID have been received (first 57 symbols)
  * Perform BCH check on received NID
@@ -38,6 +38,7 @@ class p25_framer
         void set_nac(uint32_t nac) { d_expected_nac = nac; }
         void set_debug(int debug) { d_debug = debug; }
         bool rx_sym(uint8_t dibit) ;
+        int hunt_sync(const uint8_t *syms, int nsyms);
         uint32_t load_nid(const uint8_t *syms, int nsyms, const uint64_t fs);
         bool load_body(const uint8_t * syms, int nsyms);
 
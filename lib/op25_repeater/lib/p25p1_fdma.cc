@@ -198,7 +198,7 @@ namespace gr {
                 fprintf(stderr, "%s p25p1_fdma::set_nac: 0x%03x\n", logts.get(d_msgq_id), d_nac);
         }
 
-        p25p1_fdma::p25p1_fdma(const op25_audio& udp, log_ts& logger, int debug, bool do_imbe, bool do_output, bool do_msgq, gr::msg_queue::sptr queue, std::deque<int16_t> &output_queue, bool do_audio_output, bool soft_vocoder, int msgq_id) :
+        p25p1_fdma::p25p1_fdma(const op25_audio& udp, log_ts& logger, int debug, bool do_imbe, bool do_output, bool do_msgq, gr::msg_queue::sptr queue, sample_ring<int16_t> &output_queue, bool do_audio_output, bool soft_vocoder, int msgq_id) :
             write_bufp(0),
             d_debug(debug),
             d_do_imbe(do_imbe),
@@ -793,9 +793,7 @@ namespace gr {
                             if (op25audio.enabled()) {      // decoded audio goes out via UDP (normal code path)
                                 op25audio.send_audio(snd, SND_FRAME * sizeof(int16_t));
                             } else {                        // decoded audio back to gnuradio (still supported?)
-                                for (int i = 0; i < SND_FRAME; i++) {
-                                    output_queue.push_back(snd[i]);
-                                }
+                                output_queue.push_back(snd, SND_FRAME);
                             }
                         } else {
 		                    // For encrypted voice without a valid key, push silent audio frames
@@ -902,8 +900,12 @@ namespace gr {
 
         // Construct a frame one symbol at a time (used by rx.py)
         void p25p1_fdma::rx_sym (const uint8_t *syms, int nsyms) {
-            for (int i1 = 0; i1 < nsyms; i1++) {
-                if(framer->rx_sym(syms[i1])) {   // complete frame was detected
+            int i1 = 0;
+            while (i1 < nsyms) {
+                i1 += framer->hunt_sync(syms + i1, nsyms - i1);   // skip ahead to the next frame sync
+                if (i1 >= nsyms)
+                    break;
+                if(framer->rx_sym(syms[i1++])) {   // complete frame was detected
                     if (framer->nac == 0) {  // discard frame if NAC is invalid
                         continue;
                     }
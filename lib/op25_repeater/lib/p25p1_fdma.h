@@ -24,6 +24,7 @@
 
 #include <gnuradio/msg_queue.h>
 #include <deque>
+#include "sample_ring.h"
 
 #include "ezpwd/rs"
 
@@ -84,7 +85,7 @@ namespace gr {
                 bool d_soft_vocoder;
                 int d_nac;
                 gr::msg_queue::sptr d_msg_queue;
-                std::deque<int16_t> &output_queue;
+                sample_ring<int16_t> &output_queue;
                 p25_framer* framer;
                 op25_timer qtimer;
 				software_imbe_decoder software_decoder;
@@ -123,7 +124,7 @@ namespace gr {
                 void crypt_reset();
                 void crypt_key(uint16_t keyid, uint8_t algid, const std::vector<uint8_t> &key);
                 void rx_sym (const uint8_t *syms, int nsyms);
-                p25p1_fdma(const op25_audio& udp,  log_ts& logger, int debug, bool do_imbe, bool do_output, bool do_msgq, gr::msg_queue::sptr queue, std::deque<int16_t> &output_queue, bool do_audio_output, bool soft_vocoder, int msgq_id = 0);
+                p25p1_fdma(const op25_audio& udp,  log_ts& logger, int debug, bool do_imbe, bool do_output, bool do_msgq, gr::msg_queue::sptr queue, sample_ring<int16_t> &output_queue, bool do_audio_output, bool soft_vocoder, int msgq_id = 0);
                 ~p25p1_fdma();
                 uint32_t load_nid(const uint8_t *syms, int nsyms, const uint64_t fs);
                 bool load_body(const uint8_t * syms, int nsyms);
@@ -90,7 +90,7 @@ static const uint8_t mac_msg_len[256] = {
 	28,  0,  0, 14, 17, 14,  0,  0, 16,  8, 11,  0, 13, 19,  0,  0, 
 	 0,  0, 16, 14,  0,  0, 12,  0, 22,  0, 11, 13, 11,  0, 15,  0 };
 
-p25p2_tdma::p25p2_tdma(const op25_audio& udp, log_ts& logger, int slotid, int debug, bool do_msgq, gr::msg_queue::sptr queue, std::deque<int16_t> &qptr, bool do_audio_output, bool soft_vocoder, int msgq_id) :	// constructor
+p25p2_tdma::p25p2_tdma(const op25_audio& udp, log_ts& logger, int slotid, int debug, bool do_msgq, gr::msg_queue::sptr queue, sample_ring<int16_t> &qptr, bool do_audio_output, bool soft_vocoder, int msgq_id) :	// constructor
 	tdma_xormask(new uint8_t[SUPERFRAME_SIZE]),
 	symbols_received(0),
 	packets(0),
@@ -664,10 +664,10 @@ void p25p2_tdma::handle_voice_frame(const uint8_t dibits[], int slot, int voice_
 	}
 
 	// Populate output buffer with either audio samples or silence
+	output_queue_decode.push_back(samples_buf, IMBE_SAMPLES_PER_FRAME); // outputs the sound
 	write_bufp = 0;
 	for (int i=0; i < IMBE_SAMPLES_PER_FRAME; i++) {
 		snd = samples_buf[i];
-		output_queue_decode.push_back(snd); // outputs the sound
 		write_buf[write_bufp++] = snd & 0xFF ;
 		write_buf[write_bufp++] = snd >> 8;
 	}
@@ -23,6 +23,7 @@
 
 #include <stdint.h>
 #include <deque>
+#include "sample_ring.h"
 #include <vector>
 #include <gnuradio/msg_queue.h>
 #include "mbelib.h"
@@ -43,7 +44,7 @@
 class p25p2_tdma
 {
 public:
-	p25p2_tdma(const op25_audio& udp, log_ts& logger, int slotid, int debug, bool do_msgq, gr::msg_queue::sptr queue, std::deque<int16_t> &qptr, bool do_audio_output, bool soft_vocoder, int msgq_id = 0) ;	// constructor
+	p25p2_tdma(const op25_audio& udp, log_ts& logger, int slotid, int debug, bool do_msgq, gr::msg_queue::sptr queue, sample_ring<int16_t> &qptr, bool do_audio_output, bool soft_vocoder, int msgq_id = 0) ;	// constructor
 	int handle_packet(uint8_t dibits[], const uint64_t fs) ;
 	void set_slotid(int slotid);
 	void call_end();
@@ -80,7 +81,7 @@ private:
 	software_imbe_decoder software_decoder;
 	imbe_vocoder vocoder;
 	gr::msg_queue::sptr d_msg_queue;
-	std::deque<int16_t> &output_queue_decode;
+	sample_ring<int16_t> &output_queue_decode;
 	bool d_do_msgq;
 	int d_msgq_id;
 	bool d_do_audio_output;
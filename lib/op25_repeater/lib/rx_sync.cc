@@ -220,7 +220,7 @@ void rx_sync::ysf_sync(const uint8_t dibitbuf[], bool& ysf_fullrate, bool& unmut
 		fprintf(stderr, "%s ysf_sync: muting audio: dt: %d, rc: %d\n", logts.get(d_msgq_id), d_shift_reg, rc);
 }
 
-rx_sync::rx_sync(const char * options, log_ts& logger, int debug, int msgq_id, gr::msg_queue::sptr queue, std::array<std::deque<int16_t>, 2> &output_queue, bool d_soft_vocoder) :	// constructor
+rx_sync::rx_sync(const char * options, log_ts& logger, int debug, int msgq_id, gr::msg_queue::sptr queue, std::array<sample_ring<int16_t>, 2> &output_queue, bool d_soft_vocoder) :	// constructor
 	sync_timer(op25_timer(1000000)),
 	d_symbol_count(0),
 	d_sync_reg(0),
@@ -450,14 +450,11 @@ void rx_sync::codeword(const uint8_t* cw, const enum codeword_types codeword_typ
 			}
 		}
 	}
-	float snd;
-	for (int i=0; i < NSAMP_OUTPUT; i++) {
-		if (do_silence) {
-			snd = 0.0f;
-		} else {
-			snd = samp_buf[i];
-		}
-		output_queue[slot_id].push_back(snd);
+	if (do_silence) {
+		static const int16_t silence[NSAMP_OUTPUT] = {0};
+		output_queue[slot_id].push_back(silence, NSAMP_OUTPUT);
+	} else {
+		output_queue[slot_id].push_back(samp_buf, NSAMP_OUTPUT);
 	}
 	//output(samp_buf, slot_id);
 }
@@ -501,6 +498,55 @@ int rx_sync::get_cc(int slot) {
 	return -1;
 }
 
+// True if reg ends in an exact copy of any known sync pattern. That is the
+// whole sync test rx_sym() makes while no protocol is being tracked.
+static inline bool idle_sync_match(uint64_t reg)
+{
+	for (int i = 0; i < KNOWN_MAGICS; i++) {
+		const uint64_t mask = (1LL << MODE_DATA[SYNC_MAGIC[i].type].sync_len) - 1LL;
+		if (((SYNC_MAGIC[i].magic ^ reg) & mask) == 0)
+			return true;
+	}
+	return false;
+}
+
+// Fast path for an idle receiver: shift symbols into the sync register and
+// circular buffer until one would complete a sync pattern, leaving that
+// symbol for rx_sym(). Returns the number of symbols consumed.
+int rx_sync::hunt_sync(const uint8_t *syms, int nsyms)
+{
+	if (d_slot_mask & 0x4) // framing disabled, rx_sym() would ignore these
+		return nsyms;
+	if (d_current_type != RX_TYPE_NONE)
+		return 0;
+
+	uint64_t reg = d_sync_reg;
+	int i = 0;
+	while (i < nsyms) {
+		uint64_t next = (reg << 2) | (syms[i] & 3);
+		if (idle_sync_match(next))
+			break;
+		reg = next;
+		cbuf_insert(syms[i++]);
+	}
+	d_sync_reg = reg;
+	d_symbol_count += i;
+	if ((i > 0) && sync_timer.expired()) {
+		sync_timeout(RX_TYPE_NONE);
+	}
+	return i;
+}
+
+void rx_sync::rx_syms(const uint8_t *syms, int nsyms)
+{
+	int i = 0;
+	while (i < nsyms) {
+		i += hunt_sync(syms + i, nsyms - i);
+		if (i < nsyms)
+			rx_sym(syms[i++]);
+	}
+}
+
 void rx_sync::rx_sym(const uint8_t sym)
 {
 	uint8_t bitbuf[864*2];
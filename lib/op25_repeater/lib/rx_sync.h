@@ -28,6 +28,7 @@
 #include <string>
 #include <iostream>
 #include <deque>
+#include "sample_ring.h"
 #include <assert.h>
 #include <gnuradio/msg_queue.h>
 
@@ -114,6 +115,7 @@ enum codeword_types {
 class rx_sync : public rx_base {
 public:
 	void rx_sym(const uint8_t sym);
+	void rx_syms(const uint8_t *syms, int nsyms);
 	void sync_reset(void);
 	void reset_timer(void);
 	void call_end(void);
@@ -128,13 +130,14 @@ public:
 	int get_dst_id(int slot);
 	int get_cc(int slot);
 	std::pair<bool,long> get_terminated(int slot);
-	rx_sync(const char * options, log_ts& logger, int debug, int msgq_id, gr::msg_queue::sptr queue, std::array<std::deque<int16_t>, 2> &output_queue, bool d_soft_vocoder);
+	rx_sync(const char * options, log_ts& logger, int debug, int msgq_id, gr::msg_queue::sptr queue, std::array<sample_ring<int16_t>, 2> &output_queue, bool d_soft_vocoder);
 	~rx_sync();
 
 private:
 	void sync_timeout(rx_types proto);
 	void sync_established(rx_types proto);
 	void cbuf_insert(const uint8_t c);
+	int hunt_sync(const uint8_t *syms, int nsyms);
 	void ysf_sync(const uint8_t dibitbuf[], bool& ysf_fullrate, bool& unmute);
 	void codeword(const uint8_t* cw, const enum codeword_types codeword_type, int slot_id);
 	void output(int16_t * samp_buf, const ssize_t slot_id);
@@ -168,7 +171,7 @@ private:
 	bool d_soft_vocoder;
 	software_imbe_decoder d_software_decoder[2];
 	imbe_vocoder d_imbe_vocoder[2];
-	std::deque<int16_t> d_output_queue[2];
+	sample_ring<int16_t> d_output_queue[2];
 	dmr_cai dmr;
 	int d_msgq_id;
 	gr::msg_queue::sptr d_msg_queue;
@@ -176,7 +179,7 @@ private:
 	int d_debug;
 	op25_audio d_audio;
 	log_ts& logts;
-	std::array<std::deque<int16_t>, 2> &output_queue;
+	std::array<sample_ring<int16_t>, 2> &output_queue;
 	int src_id[2];
 };
 
@@ -0,0 +1,103 @@
+/* -*- c++ -*- */
+/*
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_SAMPLE_RING_H
+#define INCLUDED_SAMPLE_RING_H
+
+#include <algorithm>
+#include <cstring>
+#include <stddef.h>
+#include <vector>
+
+/*
+ * FIFO of decoded audio samples between the voice decoders and a frame
+ * assembler's general_work(). Storage is a preallocated power-of-two ring,
+ * so the steady state does no allocation and drains with at most two
+ * memcpy()s. If a consumer falls behind the ring doubles rather than
+ * dropping audio.
+ */
+template <class T>
+class sample_ring {
+public:
+	explicit sample_ring(size_t capacity = 8192) :
+		d_buf(round_up(capacity)),
+		d_mask(d_buf.size() - 1),
+		d_head(0),
+		d_tail(0)
+	{
+	}
+
+	size_t size() const { return d_tail - d_head; }
+	bool empty() const { return d_tail == d_head; }
+	size_t capacity() const { return d_buf.size(); }
+	void clear() { d_head = d_tail = 0; }
+
+	const T& operator[](size_t i) const { return d_buf[(d_head + i) & d_mask]; }
+
+	void push_back(const T& v) {
+		if (size() == d_buf.size())
+			grow(size() + 1);
+		d_buf[d_tail & d_mask] = v;
+		d_tail++;
+	}
+
+	void push_back(const T* v, size_t n) {
+		if (size() + n > d_buf.size())
+			grow(size() + n);
+		size_t pos = d_tail & d_mask;
+		size_t first = std::min(n, d_buf.size() - pos);
+		memcpy(&d_buf[pos], v, first * sizeof(T));
+		memcpy(&d_buf[0], v + first, (n - first) * sizeof(T));
+		d_tail += n;
+	}
+
+	// Moves up to n samples to out, returns how many were moved
+	size_t pop_front(T* out, size_t n) {
+		n = std::min(n, size());
+		size_t pos = d_head & d_mask;
+		size_t first = std::min(n, d_buf.size() - pos);
+		memcpy(out, &d_buf[pos], first * sizeof(T));
+		memcpy(out + first, &d_buf[0], (n - first) * sizeof(T));
+		d_head += n;
+		return n;
+	}
+
+private:
+	std::vector<T> d_buf;
+	size_t d_mask;
+	size_t d_head;
+	size_t d_tail;
+
+	static size_t round_up(size_t n) {
+		size_t p = 1;
+		while (p < n)
+			p <<= 1;
+		return p;
+	}
+
+	void grow(size_t needed) {
+		std::vector<T> buf(round_up(needed));
+		size_t n = pop_front(&buf[0], size());
+		d_buf.swap(buf);
+		d_mask = d_buf.size() - 1;
+		d_head = 0;
+		d_tail = n;
+	}
+};
+
+#endif /* INCLUDED_SAMPLE_RING_H */
@@ -729,6 +729,35 @@ static const float PhzNz[57] = {
 	0.068775, 0.520336, 2.339119, -0.808328, 1.332154, 2.929768, -0.338316, 0.022767, -1.063795
 };
 
+// Twiddles for the unvoiced DFT in synth_unvoiced(). The angle depends only
+// on the bin and sample index, so the table is built once per process with the
+// same expression the loop used to evaluate (twice) for every bin of every
+// frame, keeping the synthesized audio bit-for-bit identical.
+typedef decltype(cos(float())) uv_trig_t;
+
+struct uv_dft_table {
+   enum { BINS = 129, SAMPLES = 211 };
+   uv_trig_t re[BINS][SAMPLES];
+   uv_trig_t im[BINS][SAMPLES];
+
+   uv_dft_table() {
+      for (int em = 0; em < BINS; em++) {
+         for (int en = 0; en < SAMPLES; en++) {
+            float exp = -0.0078125 * M_PI * em * (en - 105);
+            re[em][en] = cos(exp);
+            im[em][en] = sin(exp);
+         }
+      }
+   }
+};
+
+static const uv_dft_table &
+get_uv_dft_table()
+{
+   static const uv_dft_table table;
+   return table;
+}
+
 software_imbe_decoder::software_imbe_decoder()
 {
    int i,j;
@@ -1500,6 +1529,13 @@ software_imbe_decoder::synth_unvoiced()
       u[en] = next_u(u[en-1]);
    }
 
+   // windowed noise, shared by every unvoiced bin below
+   const uv_dft_table &dft = get_uv_dft_table();
+   float uw_noise[211];
+   for (en = 0; en < 211; en++) {
+      uw_noise[en] = u[en] * ws[en];
+   }
+
    ell = 0; bl =(int) ceilf(128 / M_PI *(ell + .5) * w0);
    for(em = 0; em <= bl - 1; em++) {
       Uwi[em] = 0; Uwq[em] = 0;
@@ -1518,10 +1554,19 @@ software_imbe_decoder::synth_unvoiced()
          for(em = al; em <= bl - 1; em++) {
             Uwi[em] = 0;
             Uwq[em] = 0;
-            for (en = 0; en < 211; en++) {
-               float exp = -0.0078125 * M_PI * em * (en - 105);
-               Uwi[em] = Uwi[em] + u[en] * ws[en] * cos(exp);
-               Uwq[em] = Uwq[em] + u[en] * ws[en] * sin(exp);
+            if (em < uv_dft_table::BINS) {
+               const uv_trig_t *re = dft.re[em];
+               const uv_trig_t *im = dft.im[em];
+               for (en = 0; en < 211; en++) {
+                  Uwi[em] = Uwi[em] + uw_noise[en] * re[en];
+                  Uwq[em] = Uwq[em] + uw_noise[en] * im[en];
+               }
+            } else {
+               for (en = 0; en < 211; en++) {
+                  float exp = -0.0078125 * M_PI * em * (en - 105);
+                  Uwi[em] = Uwi[em] + uw_noise[en] * cos(exp);
+                  Uwq[em] = Uwq[em] + uw_noise[en] * sin(exp);
+               }
             }
          }
          //precompute Tmp = <most of big hairy equation>
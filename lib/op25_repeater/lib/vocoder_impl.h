@@ -28,6 +28,7 @@
 #include <stdint.h>
 #include <vector>
 #include <deque>
+#include "sample_ring.h"
 
 #include "op25_audio.h"
 #include "p25p1_voice_encode.h"
@@ -65,7 +66,7 @@ namespace gr {
   private:
 
 	std::deque<uint8_t> output_queue;
-	std::deque<int16_t> output_queue_decode;
+	sample_ring<int16_t> output_queue_decode;
 	int opt_udp_port;
 	bool opt_encode_flag;
         op25_audio op25audio;
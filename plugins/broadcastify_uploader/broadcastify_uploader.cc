@@ -121,7 +121,7 @@ public:
     return res;
   }
 
-  int upload(Call_Data_t call_info) {
+  int upload(const Call_Data_t &call_info) {
 
     CURLMcode res;
     CURLM *multi_handle;
@@ -316,7 +316,7 @@ public:
     }
   }
 
-  int call_end(Call_Data_t call_info) {
+  int call_end(const Call_Data_t &call_info) override {
     return upload(call_info);
   }
 
@@ -44,7 +44,7 @@ public:
     ((std::string *)userp)->append((char *)contents, size * nmemb);
     return size * nmemb;
   }
-  int upload(Call_Data_t call_info) {
+  int upload(const Call_Data_t &call_info) {
     std::string api_key;
     std::string openmhz_sysid;
     Openmhz_System *sys = get_openmhz_system(call_info.short_name);
@@ -330,7 +330,7 @@ public:
     return 1;
   }
 
-  int call_end(Call_Data_t call_info) {
+  int call_end(const Call_Data_t &call_info) override {
     return upload(call_info);
   }
 
@@ -47,7 +47,7 @@ public:
     return size * nmemb;
   }
 
-  int upload(Call_Data_t call_info) {
+  int upload(const Call_Data_t &call_info) {
     std::string api_key;
     uint32_t system_id;
     std::string talkgroup_group = call_info.talkgroup_group;
@@ -371,7 +371,7 @@ public:
     return 1;
   }
 
-  int call_end(Call_Data_t call_info) {
+  int call_end(const Call_Data_t &call_info) override {
     return upload(call_info);
   }
 
@@ -212,7 +212,7 @@ class Simple_Stream : public Plugin_Api {
     return 0;
   }
 
-  int call_end(Call_Data_t call_info) {
+  int call_end(const Call_Data_t &call_info) override {
     boost::system::error_code error;
     BOOST_FOREACH (auto stream, streams){
       if (stream.sendJSON == true && stream.sendCallEnd == true){
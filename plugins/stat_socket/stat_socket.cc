@@ -42,6 +42,7 @@ class Stat_Socket : public Plugin_Api {
   std::vector<System *> systems;
   std::vector<Call *> calls;
   Config* config;
+  Json_Writer writer;
 
 public:
   /**
@@ -55,13 +56,38 @@ public:
     if (m_open == false)
       return 0;
       
-    boost::property_tree::ptree nodes;
 
+    begin_message();
+    writer.begin_array("rates");
     for (std::vector<System *>::iterator it = systems.begin(); it != systems.end(); it++) {
       System *system = *it;
-      nodes.push_back(std::make_pair("", system->get_stats_current(timeDiff)));
+      system->write_stats_current(writer, timeDiff);
     }
-    return send_object(nodes, "rates", "rates");
+    writer.end_array();
+    return end_message("rates");
+  }
+
+  int block_stats(const std::vector<Block_Stats> &stats, float timeDiff) {
+    if (m_open == false)
+      return 0;
+
+    begin_message();
+    writer.put("interval", timeDiff);
+    writer.begin_array("blocks");
+    for (std::vector<Block_Stats>::const_iterator it = stats.begin(); it != stats.end(); it++) {
+      writer.begin_object();
+      writer.put("group", it->group);
+      writer.put("block", it->block);
+      writer.put("count", it->count);
+      writer.put("cpu", it->work_seconds / timeDiff * 100);
+      writer.put("itemsIn", it->items_in);
+      writer.put("itemsOut", it->items_out);
+      writer.put("inputFull", it->input_full);
+      writer.put("inputFullMax", it->input_full_max);
+      writer.end_object();
+    }
+    writer.end_array();
+    return end_message("block_stats");
   }
 
   Stat_Socket() : m_open(false), m_done(false), m_config_sent(false) {
@@ -93,56 +119,57 @@ public:
     if (config_sent())
       return;
 
-    boost::property_tree::ptree root;
-    boost::property_tree::ptree systems_node;
-    boost::property_tree::ptree sources_node;
+    writer.clear();
+    writer.begin_object();
+    writer.begin_array("sources");
 
     for (std::vector<Source *>::iterator it = sources.begin(); it != sources.end(); it++) {
       Source *source = *it;
       std::vector<Gain_Stage_t> gain_stages;
-      boost::property_tree::ptree source_node;
-      source_node.put("source_num", source->get_num());
-      source_node.put("antenna", source->get_antenna());
-
-      source_node.put("silence_frames", source->get_silence_frames());
-
-      source_node.put("min_hz", source->get_min_hz());
-      source_node.put("max_hz", source->get_max_hz());
-      source_node.put("center", source->get_center());
-      source_node.put("rate", source->get_rate());
-      source_node.put("driver", source->get_driver());
-      source_node.put("device", source->get_device());
-      source_node.put("error", source->get_error());
-      source_node.put("gain", source->get_gain());
+      writer.begin_object();
+      writer.put("source_num", source->get_num());
+      writer.put("antenna", source->get_antenna());
+
+      writer.put("silence_frames", source->get_silence_frames());
+
+      writer.put("min_hz", source->get_min_hz());
+      writer.put("max_hz", source->get_max_hz());
+      writer.put("center", source->get_center());
+      writer.put("rate", source->get_rate());
+      writer.put("driver", source->get_driver());
+      writer.put("device", source->get_device());
+      writer.put("error", source->get_error());
+      writer.put("gain", source->get_gain());
       gain_stages = source->get_gain_stages();
       for (std::vector<Gain_Stage_t>::iterator gain_it = gain_stages.begin(); gain_it != gain_stages.end(); gain_it++) {
-        source_node.put(gain_it->stage_name + "_gain", gain_it->value);
+        writer.key(gain_it->stage_name + "_gain");
+        writer.put(NULL, gain_it->value);
       }
-      source_node.put("antenna", source->get_antenna());
-      source_node.put("analog_recorders", source->analog_recorder_count());
-      source_node.put("digital_recorders", source->digital_recorder_count());
-      source_node.put("debug_recorders", source->debug_recorder_count());
-      source_node.put("sigmf_recorders", source->sigmf_recorder_count());
-      sources_node.push_back(std::make_pair("", source_node));
+      writer.put("analog_recorders", source->analog_recorder_count());
+      writer.put("digital_recorders", source->digital_recorder_count());
+      writer.put("debug_recorders", source->debug_recorder_count());
+      writer.put("sigmf_recorders", source->sigmf_recorder_count());
+      writer.end_object();
     }
+    writer.end_array();
 
+    writer.begin_array("systems");
     for (std::vector<System *>::iterator it = systems.begin(); it != systems.end(); ++it) {
       System *sys = (System *)*it;
 
-      boost::property_tree::ptree sys_node;
-      boost::property_tree::ptree channels_node;
-      sys_node.put("audioArchive", sys->get_audio_archive());
-      sys_node.put("systemType", sys->get_system_type());
-      sys_node.put("shortName", sys->get_short_name());
-      sys_node.put("sysNum", sys->get_sys_num());
-      sys_node.put("uploadScript", sys->get_upload_script());
-      sys_node.put("recordUnkown", sys->get_record_unknown());
-      sys_node.put("callLog", sys->get_call_log());
-      sys_node.put("talkgroupsFile", sys->get_talkgroups_file());
-      sys_node.put("analog_levels", sys->get_analog_levels());
-      sys_node.put("digital_levels", sys->get_digital_levels());
-      sys_node.put("qpsk", sys->get_qpsk_mod());
-      sys_node.put("squelch_db", sys->get_squelch_db());
+      writer.begin_object();
+      writer.put("audioArchive", sys->get_audio_archive());
+      writer.put("systemType", sys->get_system_type());
+      writer.put("shortName", sys->get_short_name());
+      writer.put("sysNum", sys->get_sys_num());
+      writer.put("uploadScript", sys->get_upload_script());
+      writer.put("recordUnkown", sys->get_record_unknown());
+      writer.put("callLog", sys->get_call_log());
+      writer.put("talkgroupsFile", sys->get_talkgroups_file());
+      writer.put("analog_levels", sys->get_analog_levels());
+      writer.put("digital_levels", sys->get_digital_levels());
+      writer.put("qpsk", sys->get_qpsk_mod());
+      writer.put("squelch_db", sys->get_squelch_db());
       std::vector<double> channels;
 
       if ((sys->get_system_type() == "conventional") || (sys->get_system_type() == "conventionalP25") || (sys->get_system_type() == "conventionalDMR") || (sys->get_system_type() == "conventionalSIGMF") ) {
@@ -151,112 +178,110 @@ public:
         channels = sys->get_control_channels();
       }
 
-      //std::cout << "starts: " << std::endl;
-
+      writer.begin_array("channels");
       for (std::vector<double>::iterator chan_it = channels.begin(); chan_it != channels.end(); chan_it++) {
-        double channel = *chan_it;
-        boost::property_tree::ptree channel_node;
-        //std::cout << "Hello: " << channel << std::endl;
-        channel_node.put("", channel);
-
-        // Add this node to the list.
-        channels_node.push_back(std::make_pair("", channel_node));
+        writer.push(*chan_it);
       }
-      sys_node.add_child("channels", channels_node);
+      writer.end_array();
 
       if (sys->get_system_type() == "smartnet") {
-        sys_node.put("bandplan", sys->get_bandplan());
-        sys_node.put("bandfreq", sys->get_bandfreq());
-        sys_node.put("bandplan_base", sys->get_bandplan_base());
-        sys_node.put("bandplan_high", sys->get_bandplan_high());
-        sys_node.put("bandplan_spacing", sys->get_bandplan_spacing());
-        sys_node.put("bandplan_offset", sys->get_bandplan_offset());
+        writer.put("bandplan", sys->get_bandplan());
+        writer.put("bandfreq", sys->get_bandfreq());
+        writer.put("bandplan_base", sys->get_bandplan_base());
+        writer.put("bandplan_high", sys->get_bandplan_high());
+        writer.put("bandplan_spacing", sys->get_bandplan_spacing());
+        writer.put("bandplan_offset", sys->get_bandplan_offset());
       }
-      systems_node.push_back(std::make_pair("", sys_node));
+      writer.end_object();
     }
-    root.add_child("sources", sources_node);
-    root.add_child("systems", systems_node);
-    root.put("captureDir", this->config->capture_dir);
-    root.put("uploadServer", this->config->upload_server);
-
-    // root.put("defaultMode", default_mode);
-    root.put("callTimeout", this->config->call_timeout);
-    root.put("logFile", this->config->log_file);
-    root.put("instanceId", this->config->instance_id);
-    root.put("instanceKey", this->config->instance_key);
-    root.put("logFile", this->config->log_file);
-    root.put("type", "config");
+    writer.end_array();
+    writer.put("captureDir", this->config->capture_dir);
+    writer.put("uploadServer", this->config->upload_server);
+
+    // writer.put("defaultMode", default_mode);
+    writer.put("callTimeout", this->config->call_timeout);
+    writer.put("logFile", this->config->log_file);
+    writer.put("instanceId", this->config->instance_id);
+    writer.put("instanceKey", this->config->instance_key);
+    writer.put("type", "config");
 
     if (this->config->broadcast_signals == true) {
-      root.put("broadcast_signals", this->config->broadcast_signals);
+      writer.put("broadcast_signals", this->config->broadcast_signals);
     }
+    writer.end_object();
 
-    std::stringstream stats_str;
-    boost::property_tree::write_json(stats_str, root);
-
-    // std::cout << stats_str;
-    send_stat(stats_str.str());
+    send_stat(writer.str());
     m_config_sent = true;
   }
 
   int send_systems(std::vector<System *> systems) {
     if (m_open == false)
       return 0;
-    boost::property_tree::ptree node;
 
+    begin_message();
+    writer.begin_array("systems");
     for (std::vector<System *>::iterator it = systems.begin(); it != systems.end(); it++) {
       System *system = *it;
-      node.push_back(std::make_pair("", system->get_stats()));
+      system->write_stats(writer);
     }
-    return send_object(node, "systems", "systems");
+    writer.end_array();
+    return end_message("systems");
   }
 
   int send_system(System *system) {
     if (m_open == false)
       return 0;
 
-    return send_object(system->get_stats(), "system", "system");
+    begin_message();
+    writer.key("system");
+    system->write_stats(writer);
+    return end_message("system");
 
   }
 
   int calls_active(std::vector<Call *> calls) {
     if (m_open == false)
       return 0;
-    boost::property_tree::ptree node;
 
+    begin_message();
+    writer.begin_array("calls");
     for (std::vector<Call *>::iterator it = calls.begin(); it != calls.end(); it++) {
       Call *call = *it;
       //if (call->get_state() == RECORDING) {
-        node.push_back(std::make_pair("", call->get_stats()));
+        call->write_stats(writer);
       //}
     }
-
-    return send_object(node, "calls", "calls_active");
+    writer.end_array();
+    return end_message("calls_active");
   }
 
   int send_recorders(std::vector<Recorder *> recorders) {
 
     if (m_open == false)
       return 0;
-    boost::property_tree::ptree node;
 
+    begin_message();
+    writer.begin_array("recorders");
     for (std::vector<Recorder *>::iterator it = recorders.begin(); it != recorders.end(); it++) {
       Recorder *recorder = *it;
-      node.push_back(std::make_pair("", recorder->get_stats()));
+      recorder->write_stats(writer);
     }
-
-    return send_object(node, "recorders", "recorders");
+    writer.end_array();
+    return end_message("recorders");
   }
 
   int call_start(Call *call) {
     if (m_open == false)
       return 0;
 
-    return send_object(call->get_stats(), "call", "call_start");
+    begin_message();
+    writer.key("call");
+    call->write_stats(writer);
+    return end_message("call_start");
 
   }
 
-  int call_end(Call_Data_t call_info) {
+  int call_end(const Call_Data_t &call_info) override {
     if (m_open == false)
       return 0;
     return 0;
@@ -267,23 +292,30 @@ public:
     if (m_open == false)
       return 0;
 
-    return send_object(recorder->get_stats(), "recorder", "recorder");
+    begin_message();
+    writer.key("recorder");
+    recorder->write_stats(writer);
+    return end_message("recorder");
   }
 
-  int send_object(boost::property_tree::ptree data, std::string name, std::string type) {
-    if (m_open == false)
-      return 0;
-    boost::property_tree::ptree root;
+  // Messages are written straight into the writer's buffer, which is reused
+  // from one message to the next. The monitor thread is the only one that
+  // uses it.
+  void begin_message() {
+    writer.clear();
+    writer.begin_object();
+  }
 
-    root.add_child(name, data);
-    root.put("type", type);
-    root.put("instanceId", this->config->instance_id);
-    root.put("instanceKey", this->config->instance_key);
-    std::stringstream stats_str;
-    boost::property_tree::write_json(stats_str, root);
+  int end_message(const char *type) {
+    return end_message(writer, type);
+  }
 
-    // std::cout << stats_str;
-    return send_stat(stats_str.str());
+  int end_message(Json_Writer &message, const char *type) {
+    message.put("type", type);
+    message.put("instanceId", this->config->instance_id);
+    message.put("instanceKey", this->config->instance_key);
+    message.end_object();
+    return send_stat(message.str());
   }
 
 
@@ -417,7 +449,7 @@ public:
     //Need to receive the message so they don't build up. TrunkPlayer sends a message to acknowledge what TrunkRecorder sends.
   }
 
-  int send_stat(std::string val) {
+  int send_stat(const std::string &val) {
     websocketpp::lib::error_code ec;
     if (m_open) {
       m_client.send(m_hdl, val, websocketpp::frame::opcode::text, ec);
@@ -441,24 +473,31 @@ public:
     if (m_open == false || this->config->broadcast_signals == false)
       return 1;
 
-    boost::property_tree::ptree signal;
-    signal.put("unit_id", unitId);
-    //signal.put("signal_system_type", signaling_type);
-    //signal.put("signal_type", sig_type);
+    // Signals can come from the decoder threads, so they get their own writer
+    Json_Writer message;
+    message.begin_object();
+    message.begin_object("signal");
+    message.put("unit_id", unitId);
+    //message.put("signal_system_type", signaling_type);
+    //message.put("signal_type", sig_type);
 
     if (call != NULL) {
-      signal.add_child("call", call->get_stats());
+      message.key("call");
+      call->write_stats(message);
     }
 
     if (recorder != NULL) {
-      signal.add_child("recorder", recorder->get_stats());
+      message.key("recorder");
+      recorder->write_stats(message);
     }
 
     if (system != NULL) {
-      signal.add_child("system", system->get_stats());
+      message.key("system");
+      system->write_stats(message);
     }
+    message.end_object();
 
-    return send_object(signal, "signal", "signaling");
+    return end_message(message, "signaling");
   }
 
   int init(Config *config, std::vector<Source *> sources, std::vector<System *> systems) {
@@ -19,8 +19,8 @@ class System;
 
 class Call {
 public:
-  // static Call * make(long t, double f, System *s, Config c);
-  static Call *make(TrunkMessage message, System *s, Config c);
+  // static Call * make(long t, double f, System *s, Config *c);
+  static Call *make(TrunkMessage message, System *s, Config *c);
   virtual ~Call(){};
   virtual long get_call_num() = 0;
   virtual void restart_call() = 0;
@@ -35,8 +35,8 @@ public:
   virtual double get_freq() = 0;
   virtual int get_sys_num() = 0;
   virtual std::string get_short_name() = 0;
-  virtual std::string get_capture_dir() = 0;
-  virtual std::string get_temp_dir() = 0;
+  virtual const std::string &get_capture_dir() = 0;
+  virtual const std::string &get_temp_dir() = 0;
   virtual void set_freq(double f) = 0;
   virtual long get_talkgroup() = 0;
 
@@ -82,6 +82,7 @@ public:
   virtual std::string get_talkgroup_display() = 0;
   virtual void set_talkgroup_tag(std::string tag) = 0;
   virtual void clear_transmission_list() = 0;
+  virtual void write_stats(Json_Writer &writer) = 0;
   virtual boost::property_tree::ptree get_stats() = 0;
 
   virtual std::string get_talkgroup_tag() = 0;
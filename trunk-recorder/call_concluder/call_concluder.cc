@@ -1,12 +1,15 @@
 #include "call_concluder.h"
+#include "../metrics.h"
+#include "../recorder_pool.h"
+#include "call_journal.h"
 #include "../plugin_manager/plugin_manager.h"
 #include <boost/filesystem.hpp>
 #include <filesystem>
 namespace fs = std::filesystem;
 
 const int Call_Concluder::MAX_RETRY = 2;
-std::list<std::future<Call_Data_t>> Call_Concluder::call_data_workers = {};
-std::list<Call_Data_t> Call_Concluder::retry_call_list = {};
+std::list<std::future<std::unique_ptr<Call_Data_t>>> Call_Concluder::call_data_workers = {};
+std::list<std::unique_ptr<Call_Data_t>> Call_Concluder::retry_call_list = {};
 
 int combine_wav(std::string files, char *target_filename) {
   char shell_command[4000];
@@ -53,72 +56,19 @@ int convert_media(char *filename, char *converted, char *date, const char *short
 
 int create_call_json(Call_Data_t& call_info) {
   // Create call JSON, write it to disk, and pass back a json object to call_info
+  call_info.call_json = Call_Journal::to_json(call_info);
 
-  // Using nlohmann::ordered_json to preserve the previous order
-  // Bools are stored as 0 or 1 as in previous versions
-  // Call length is rounded up to the nearest second as in previous versions
-  // Time stored in fractional seconds will omit trailing zeroes per json spec (1.20 -> 1.2)
-  nlohmann::ordered_json json_data =
-      {
-          {"freq", int(call_info.freq)},
-          {"freq_error", int(call_info.freq_error)},
-          {"signal", int(call_info.signal)},
-          {"noise", int(call_info.noise)},
-          {"source_num", int(call_info.source_num)},
-          {"recorder_num", int(call_info.recorder_num)},
-          {"tdma_slot", int(call_info.tdma_slot)},
-          {"phase2_tdma", int(call_info.phase2_tdma)},
-          {"start_time", call_info.start_time},
-          {"stop_time", call_info.stop_time},
-          {"emergency", int(call_info.emergency)},
-          {"priority", call_info.priority},
-          {"mode", int(call_info.mode)},
-          {"duplex", int(call_info.duplex)},
-          {"encrypted",int(call_info.encrypted)},
-          {"call_length", int(std::round(call_info.length))},
-          {"talkgroup", call_info.talkgroup},
-          {"talkgroup_tag", call_info.talkgroup_alpha_tag},
-          {"talkgroup_description", call_info.talkgroup_description},
-          {"talkgroup_group_tag", call_info.talkgroup_tag},
-          {"talkgroup_group", call_info.talkgroup_group},
-          {"color_code", call_info.color_code},
-          {"audio_type", call_info.audio_type},
-          {"short_name", call_info.short_name}
-        };
-  // Add any patched talkgroups
-  if (call_info.patched_talkgroups.size() > 1) {
-    BOOST_FOREACH (auto &TGID, call_info.patched_talkgroups) {
-      json_data["patched_talkgroups"] += int(TGID);
-    }
-  }
-  // Add frequencies / IMBE errors
-  for (std::size_t i = 0; i < call_info.transmission_error_list.size(); i++) {
-    json_data["freqList"] += {
-        {"freq", int(call_info.freq)},
-        {"time", call_info.transmission_error_list[i].time},
-        {"pos", call_info.transmission_error_list[i].position},
-        {"len", call_info.transmission_error_list[i].total_len},
-        {"error_count", int(call_info.transmission_error_list[i].error_count)},
-        {"spike_count", int(call_info.transmission_error_list[i].spike_count)}};
-  }
-  // Add sources / tags
-  for (std::size_t i = 0; i < call_info.transmission_source_list.size(); i++) {
-    json_data["srcList"] += {
-        {"src", int(call_info.transmission_source_list[i].source)},
-        {"time", call_info.transmission_source_list[i].time},
-        {"pos", call_info.transmission_source_list[i].position},
-        {"emergency", int(call_info.transmission_source_list[i].emergency)},
-        {"signal_system", call_info.transmission_source_list[i].signal_system},
-        {"tag", call_info.transmission_source_list[i].tag}};
+  // The upload script is handed the JSON file, so it is still written for
+  // Systems that have one
+  if (Call_Journal::replaces_json_files() && (call_info.upload_script.length() == 0)) {
+    return 0;
   }
-  // Add created JSON to call_info
-  call_info.call_json = json_data;
 
   // Output the JSON status file
   std::ofstream json_file(call_info.status_filename);
   if (json_file.is_open()) {
     // Write the JSON to disk, indented 2 spaces per level
-    json_file << json_data.dump(2);
+    json_file << call_info.call_json.dump(2);
     return 0;
   } else {
     std::string loghdr = log_header( call_info.short_name, call_info.call_num, call_info.talkgroup_display , call_info.freq);
@@ -140,7 +90,7 @@ bool checkIfFile(std::string filePath) {
   return false;
 }
 
-void remove_call_files(Call_Data_t call_info, bool plugin_failure=false) {
+void remove_call_files(const Call_Data_t &call_info, bool plugin_failure=false) {
 
   if (plugin_failure) {
     std::string loghdr = log_header( call_info.short_name, call_info.call_num, call_info.talkgroup_display , call_info.freq);
@@ -157,8 +107,8 @@ void remove_call_files(Call_Data_t call_info, bool plugin_failure=false) {
   if (call_info.audio_archive || (plugin_failure && call_info.archive_files_on_failure)) {
     if (call_info.transmission_archive) {
       // if the files are being archived, move them to the capture directory
-      for (std::vector<Transmission>::iterator it = call_info.transmission_list.begin(); it != call_info.transmission_list.end(); ++it) {
-        Transmission t = *it;
+      for (std::vector<Transmission>::const_iterator it = call_info.transmission_list.begin(); it != call_info.transmission_list.end(); ++it) {
+        const Transmission &t = *it;
 
         // Only move transmission wavs if they exist
         if (checkIfFile(t.filename)) {
@@ -181,8 +131,8 @@ void remove_call_files(Call_Data_t call_info, bool plugin_failure=false) {
     }
 
     // remove the transmission files from the temp directory
-    for (std::vector<Transmission>::iterator it = call_info.transmission_list.begin(); it != call_info.transmission_list.end(); ++it) {
-      Transmission t = *it;
+    for (std::vector<Transmission>::const_iterator it = call_info.transmission_list.begin(); it != call_info.transmission_list.end(); ++it) {
+      const Transmission &t = *it;
       if (checkIfFile(t.filename)) {
         remove(t.filename);
       }
@@ -198,8 +148,8 @@ void remove_call_files(Call_Data_t call_info, bool plugin_failure=false) {
     if (checkIfFile(call_info.converted)) {
       remove(call_info.converted);
     }
-    for (std::vector<Transmission>::iterator it = call_info.transmission_list.begin(); it != call_info.transmission_list.end(); ++it) {
-      Transmission t = *it;
+    for (std::vector<Transmission>::const_iterator it = call_info.transmission_list.begin(); it != call_info.transmission_list.end(); ++it) {
+      const Transmission &t = *it;
       if (checkIfFile(t.filename)) {
         remove(t.filename);
       }
@@ -214,8 +164,10 @@ void remove_call_files(Call_Data_t call_info, bool plugin_failure=false) {
   }
 }
 
-Call_Data_t upload_call_worker(Call_Data_t call_info) {
+std::unique_ptr<Call_Data_t> upload_call_worker(std::unique_ptr<Call_Data_t> call_data) {
+  Call_Data_t &call_info = *call_data;
   int result;
+  std::chrono::steady_clock::time_point worker_start = std::chrono::steady_clock::now();
 
   if (call_info.status == INITIAL) {
     std::stringstream shell_command;
@@ -226,7 +178,7 @@ Call_Data_t upload_call_worker(Call_Data_t call_info) {
     // loop through the transmission list, pull in things to fill in totals for call_info
     // Using a for loop with iterator
     for (std::vector<Transmission>::iterator it = call_info.transmission_list.begin(); it != call_info.transmission_list.end(); ++it) {
-      Transmission t = *it;
+      const Transmission &t = *it;
 
       if (stat(t.filename, &statbuf) == 0)
       {
@@ -246,9 +198,11 @@ Call_Data_t upload_call_worker(Call_Data_t call_info) {
 
     if (result < 0) {
       call_info.status = FAILED;
-      return call_info;
+      return call_data;
     }
 
+    Call_Journal::append(call_info);
+
     if (call_info.compress_wav) {
       // TR records files as .wav files. They need to be compressed before being upload to online services.
 
@@ -264,7 +218,7 @@ Call_Data_t upload_call_worker(Call_Data_t call_info) {
 
       if (result < 0) {
         call_info.status = FAILED;
-        return call_info;
+        return call_data;
       }
     }
 
@@ -290,12 +244,14 @@ Call_Data_t upload_call_worker(Call_Data_t call_info) {
     call_info.status = RETRY;
   }
 
-  return call_info;
+  Metrics::upload_seconds.observe(std::chrono::duration<double>(std::chrono::steady_clock::now() - worker_start).count());
+
+  return call_data;
 }
 
 
 // static int rec_counter=0;
-Call_Data_t Call_Concluder::create_base_filename(Call *call, Call_Data_t call_info) {
+void Call_Concluder::create_base_filename(Call *call, Call_Data_t &call_info) {
   char base_filename[255];
   time_t work_start_time = call->get_start_time();
   std::stringstream base_path_stream;
@@ -319,16 +275,15 @@ Call_Data_t Call_Concluder::create_base_filename(Call *call, Call_Data_t call_in
   snprintf(call_info.filename, 300, "%s-call_%lu.wav", base_filename, call->get_call_num());
   snprintf(call_info.status_filename, 300, "%s-call_%lu.json", base_filename, call->get_call_num());
   snprintf(call_info.converted, 300, "%s-call_%lu.m4a", base_filename, call->get_call_num());
-
-  return call_info;
 }
 
 
-Call_Data_t Call_Concluder::create_call_data(Call *call, System *sys, Config config) {
-  Call_Data_t call_info;
+std::unique_ptr<Call_Data_t> Call_Concluder::create_call_data(Call *call, System *sys, Config &config) {
+  std::unique_ptr<Call_Data_t> call_data(new Call_Data_t());
+  Call_Data_t &call_info = *call_data;
   double total_length = 0;
 
-  call_info = create_base_filename(call, call_info);
+  create_base_filename(call, call_info);
 
   call_info.status = INITIAL;
   call_info.process_call_time = time(0);
@@ -380,7 +335,7 @@ Call_Data_t Call_Concluder::create_call_data(Call *call, System *sys, Config con
   // loop through the transmission list, pull in things to fill in totals for call_info
   // Using a for loop with iterator
   for (std::vector<Transmission>::iterator it = call_info.transmission_list.begin(); it != call_info.transmission_list.end();) {
-    Transmission t = *it;
+    const Transmission &t = *it;
 
     if (t.length < sys->get_min_tx_duration() && !call_info.encrypted) {
       if (!call_info.transmission_archive) {
@@ -461,11 +416,12 @@ Call_Data_t Call_Concluder::create_call_data(Call *call, System *sys, Config con
   call_info.archive_files_on_failure = config.archive_files_on_failure;
   call_info.length = total_length;
 
-  return call_info;
+  return call_data;
 }
 
-void Call_Concluder::conclude_call(Call *call, System *sys, Config config) {
-  Call_Data_t call_info = create_call_data(call, sys, config);
+void Call_Concluder::conclude_call(Call *call, System *sys, Config &config) {
+  std::unique_ptr<Call_Data_t> call_data = create_call_data(call, sys, config);
+  Call_Data_t &call_info = *call_data;
 
   std::string loghdr = log_header( call_info.short_name, call_info.call_num, call_info.talkgroup_display , call_info.freq);
   if(call->get_state() == MONITORING && call->get_monitoring_state() == SUPERSEDED){
@@ -503,14 +459,15 @@ void Call_Concluder::conclude_call(Call *call, System *sys, Config config) {
   }
 
 
-  call_data_workers.push_back(std::async(std::launch::async, upload_call_worker, call_info));
+  call_data_workers.push_back(std::async(std::launch::async, upload_call_worker, std::move(call_data)));
 }
 
 void Call_Concluder::manage_call_data_workers() {
-  for (std::list<std::future<Call_Data_t>>::iterator it = call_data_workers.begin(); it != call_data_workers.end();) {
+  for (std::list<std::future<std::unique_ptr<Call_Data_t>>>::iterator it = call_data_workers.begin(); it != call_data_workers.end();) {
 
     if (it->wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
-      Call_Data_t call_info = it->get();
+      std::unique_ptr<Call_Data_t> call_data = it->get();
+      Call_Data_t &call_info = *call_data;
 
       if (call_info.status == RETRY) {
         call_info.retry_attempt++;
@@ -524,23 +481,26 @@ void Call_Concluder::manage_call_data_workers() {
           long jitter = rand() % 10;
           long backoff = ((1 << call_info.retry_attempt) * 60) + jitter;
           call_info.process_call_time = time(0) + backoff;
-          retry_call_list.push_back(call_info);
+          retry_call_list.push_back(std::move(call_data));
           BOOST_LOG_TRIVIAL(error) << loghdr << std::put_time(std::localtime(&start_time), "%c %Z") << " retry attempt " << call_info.retry_attempt << " in " << backoff << "s\t retry queue: " << retry_call_list.size() << " calls";
         }
+      } else {
+        Recorder_Pool::call_concluded(call_info);
       }
       it = call_data_workers.erase(it);
     } else {
       it++;
     }
   }
-  for (std::list<Call_Data_t>::iterator it = retry_call_list.begin(); it != retry_call_list.end();) {
-    Call_Data_t call_info = *it;
-
-    if (call_info.process_call_time <= time(0)) {
-      call_data_workers.push_back(std::async(std::launch::async, upload_call_worker, call_info));
+  for (std::list<std::unique_ptr<Call_Data_t>>::iterator it = retry_call_list.begin(); it != retry_call_list.end();) {
+    if ((*it)->process_call_time <= time(0)) {
+      call_data_workers.push_back(std::async(std::launch::async, upload_call_worker, std::move(*it)));
       it = retry_call_list.erase(it);
     } else {
       it++;
     }
   }
+
+  Metrics::concluder_workers = call_data_workers.size();
+  Metrics::concluder_retries = retry_call_list.size();
 }
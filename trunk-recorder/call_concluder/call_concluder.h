@@ -5,6 +5,7 @@
 #include <ctime>
 #include <future>
 #include <list>
+#include <memory>
 #include <queue>
 #include <thread>
 #include <vector>
@@ -15,21 +16,21 @@
 #include "../systems/system.h"
 #include "../systems/system_impl.h"
 
-Call_Data_t upload_call_worker(Call_Data_t call_info);
+std::unique_ptr<Call_Data_t> upload_call_worker(std::unique_ptr<Call_Data_t> call_data);
 
 class Call_Concluder {
 
 public:
   static const int MAX_RETRY;
-  static std::list<Call_Data_t> retry_call_list;
-  static std::list<std::future<Call_Data_t>> call_data_workers;
+  static std::list<std::unique_ptr<Call_Data_t>> retry_call_list;
+  static std::list<std::future<std::unique_ptr<Call_Data_t>>> call_data_workers;
   
-  static Call_Data_t create_call_data(Call *call, System *sys, Config config);
-  static void conclude_call(Call *call, System *sys, Config config);
+  static std::unique_ptr<Call_Data_t> create_call_data(Call *call, System *sys, Config &config);
+  static void conclude_call(Call *call, System *sys, Config &config);
   static void manage_call_data_workers();
 
 private:
-  static Call_Data_t create_base_filename(Call *call, Call_Data_t call_info);
+  static void create_base_filename(Call *call, Call_Data_t &call_info);
 };
 
 #endif
@@ -0,0 +1,458 @@
+#include "call_journal.h"
+#include "../formatter.h"
+#include <boost/crc.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/log/trivial.hpp>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+const uint32_t Call_Journal::VERSION = 1;
+std::string Call_Journal::journal_dir = "";
+bool Call_Journal::journal_only = false;
+std::mutex Call_Journal::journal_mutex;
+int Call_Journal::journal_fd = -1;
+std::string Call_Journal::journal_day = "";
+int Call_Journal::unsynced_records = 0;
+time_t Call_Journal::last_sync = 0;
+
+static const char JOURNAL_MAGIC[4] = {'T', 'R', 'C', 'J'};
+
+// Records are synced to disk once a second, or sooner when this many are waiting
+static const int SYNC_BATCH = 256;
+
+// Anything larger than this is taken to be a damaged length prefix
+static const uint32_t MAX_RECORD = 16 * 1024 * 1024;
+
+static void put_u32(std::string &out, uint32_t v) {
+  char b[4] = {(char)(v & 0xFF), (char)((v >> 8) & 0xFF), (char)((v >> 16) & 0xFF), (char)((v >> 24) & 0xFF)};
+  out.append(b, 4);
+}
+
+static void put_u64(std::string &out, uint64_t v) {
+  put_u32(out, (uint32_t)(v & 0xFFFFFFFF));
+  put_u32(out, (uint32_t)(v >> 32));
+}
+
+static void put_u8(std::string &out, bool v) { out += (char)(v ? 1 : 0); }
+static void put_i32(std::string &out, int32_t v) { put_u32(out, (uint32_t)v); }
+static void put_i64(std::string &out, int64_t v) { put_u64(out, (uint64_t)v); }
+
+static void put_f64(std::string &out, double v) {
+  uint64_t bits;
+  memcpy(&bits, &v, sizeof(bits));
+  put_u64(out, bits);
+}
+
+static void put_str(std::string &out, const std::string &v) {
+  put_u32(out, v.size());
+  out.append(v);
+}
+
+// Bounds checked cursor over a payload
+struct Journal_Reader {
+  const std::string &in;
+  size_t pos;
+  bool ok;
+
+  Journal_Reader(const std::string &payload) : in(payload), pos(0), ok(true) {}
+
+  bool need(size_t n) {
+    if (!ok || (in.size() - pos < n)) {
+      ok = false;
+    }
+    return ok;
+  }
+
+  uint32_t u32() {
+    if (!need(4)) {
+      return 0;
+    }
+    const unsigned char *b = (const unsigned char *)in.data() + pos;
+    pos += 4;
+    return (uint32_t)b[0] | ((uint32_t)b[1] << 8) | ((uint32_t)b[2] << 16) | ((uint32_t)b[3] << 24);
+  }
+
+  uint64_t u64() {
+    uint64_t low = u32();
+    uint64_t high = u32();
+    return low | (high << 32);
+  }
+
+  bool u8() {
+    if (!need(1)) {
+      return false;
+    }
+    return in[pos++] != 0;
+  }
+
+  int32_t i32() { return (int32_t)u32(); }
+  int64_t i64() { return (int64_t)u64(); }
+
+  double f64() {
+    uint64_t bits = u64();
+    double v;
+    memcpy(&v, &bits, sizeof(v));
+    return v;
+  }
+
+  std::string str() {
+    uint32_t len = u32();
+    if (!need(len)) {
+      return "";
+    }
+    std::string v = in.substr(pos, len);
+    pos += len;
+    return v;
+  }
+
+  // Guards the list counts, so a bad count can't reserve gigabytes
+  uint32_t count(size_t min_item_size) {
+    uint32_t n = u32();
+    if (ok && (n > (in.size() - pos) / min_item_size)) {
+      ok = false;
+    }
+    return ok ? n : 0;
+  }
+};
+
+void Call_Journal::encode(const Call_Data_t &call_info, std::string &record) {
+  record.clear();
+  put_i64(record, call_info.call_num);
+  put_i32(record, call_info.sys_num);
+  put_str(record, call_info.short_name);
+  put_f64(record, call_info.freq);
+  put_i32(record, call_info.freq_error);
+  put_f64(record, call_info.signal);
+  put_f64(record, call_info.noise);
+  put_i32(record, call_info.source_num);
+  put_i32(record, call_info.recorder_num);
+  put_i32(record, call_info.tdma_slot);
+  put_u8(record, call_info.phase2_tdma);
+  put_i64(record, call_info.start_time);
+  put_i64(record, call_info.stop_time);
+  put_u8(record, call_info.emergency);
+  put_i32(record, call_info.priority);
+  put_u8(record, call_info.mode);
+  put_u8(record, call_info.duplex);
+  put_u8(record, call_info.encrypted);
+  put_f64(record, call_info.length);
+  put_i64(record, call_info.talkgroup);
+  put_str(record, call_info.talkgroup_alpha_tag);
+  put_str(record, call_info.talkgroup_description);
+  put_str(record, call_info.talkgroup_tag);
+  put_str(record, call_info.talkgroup_group);
+  put_i64(record, call_info.color_code);
+  put_str(record, call_info.audio_type);
+  put_str(record, call_info.filename);
+
+  put_u32(record, call_info.patched_talkgroups.size());
+  for (std::size_t i = 0; i < call_info.patched_talkgroups.size(); i++) {
+    put_i64(record, call_info.patched_talkgroups[i]);
+  }
+
+  put_u32(record, call_info.transmission_error_list.size());
+  for (std::size_t i = 0; i < call_info.transmission_error_list.size(); i++) {
+    const Call_Error &error = call_info.transmission_error_list[i];
+    put_i64(record, error.time);
+    put_f64(record, error.position);
+    put_f64(record, error.total_len);
+    put_f64(record, error.error_count);
+    put_f64(record, error.spike_count);
+  }
+
+  put_u32(record, call_info.transmission_source_list.size());
+  for (std::size_t i = 0; i < call_info.transmission_source_list.size(); i++) {
+    const Call_Source &source = call_info.transmission_source_list[i];
+    put_i64(record, source.source);
+    put_i64(record, source.time);
+    put_f64(record, source.position);
+    put_u8(record, source.emergency);
+    put_str(record, source.signal_system);
+    put_str(record, source.tag);
+  }
+}
+
+bool Call_Journal::decode(const std::string &payload, Call_Data_t &call_info) {
+  Journal_Reader in(payload);
+
+  call_info.call_num = in.i64();
+  call_info.sys_num = in.i32();
+  call_info.short_name = in.str();
+  call_info.freq = in.f64();
+  call_info.freq_error = in.i32();
+  call_info.signal = in.f64();
+  call_info.noise = in.f64();
+  call_info.source_num = in.i32();
+  call_info.recorder_num = in.i32();
+  call_info.tdma_slot = in.i32();
+  call_info.phase2_tdma = in.u8();
+  call_info.start_time = in.i64();
+  call_info.stop_time = in.i64();
+  call_info.emergency = in.u8();
+  call_info.priority = in.i32();
+  call_info.mode = in.u8();
+  call_info.duplex = in.u8();
+  call_info.encrypted = in.u8();
+  call_info.length = in.f64();
+  call_info.talkgroup = in.i64();
+  call_info.talkgroup_alpha_tag = in.str();
+  call_info.talkgroup_description = in.str();
+  call_info.talkgroup_tag = in.str();
+  call_info.talkgroup_group = in.str();
+  call_info.color_code = in.i64();
+  call_info.audio_type = in.str();
+  std::string filename = in.str();
+  snprintf(call_info.filename, sizeof(call_info.filename), "%s", filename.c_str());
+
+  uint32_t patches = in.count(8);
+  call_info.patched_talkgroups.clear();
+  for (uint32_t i = 0; i < patches; i++) {
+    call_info.patched_talkgroups.push_back(in.i64());
+  }
+
+  uint32_t errors = in.count(40);
+  call_info.transmission_error_list.clear();
+  for (uint32_t i = 0; i < errors; i++) {
+    Call_Error error;
+    error.time = in.i64();
+    error.position = in.f64();
+    error.total_len = in.f64();
+    error.error_count = in.f64();
+    error.spike_count = in.f64();
+    call_info.transmission_error_list.push_back(error);
+  }
+
+  uint32_t sources = in.count(33);
+  call_info.transmission_source_list.clear();
+  for (uint32_t i = 0; i < sources; i++) {
+    Call_Source source;
+    source.source = in.i64();
+    source.time = in.i64();
+    source.position = in.f64();
+    source.emergency = in.u8();
+    source.signal_system = in.str();
+    source.tag = in.str();
+    call_info.transmission_source_list.push_back(source);
+  }
+
+  return in.ok && (in.pos == payload.size());
+}
+
+bool Call_Journal::read_header(std::istream &in) {
+  char header[8];
+  if (!in.read(header, sizeof(header)) || (memcmp(header, JOURNAL_MAGIC, 4) != 0)) {
+    return false;
+  }
+  std::string version(header + 4, 4);
+  return Journal_Reader(version).u32() == VERSION;
+}
+
+bool Call_Journal::read_record(std::istream &in, Call_Data_t &call_info) {
+  std::string prefix(8, '\0');
+  if (!in.read(&prefix[0], 8)) {
+    return false;
+  }
+  Journal_Reader header(prefix);
+  uint32_t len = header.u32();
+  uint32_t crc = header.u32();
+  if (len > MAX_RECORD) {
+    return false;
+  }
+
+  std::string payload(len, '\0');
+  if (!in.read(&payload[0], len)) {
+    return false;
+  }
+
+  boost::crc_32_type checksum;
+  checksum.process_bytes(payload.data(), payload.size());
+  if (checksum.checksum() != crc) {
+    return false;
+  }
+  return decode(payload, call_info);
+}
+
+nlohmann::ordered_json Call_Journal::to_json(const Call_Data_t &call_info) {
+  // Using nlohmann::ordered_json to preserve the previous order
+  // Bools are stored as 0 or 1 as in previous versions
+  // Call length is rounded up to the nearest second as in previous versions
+  // Time stored in fractional seconds will omit trailing zeroes per json spec (1.20 -> 1.2)
+  nlohmann::ordered_json json_data =
+      {
+          {"freq", int(call_info.freq)},
+          {"freq_error", int(call_info.freq_error)},
+          {"signal", int(call_info.signal)},
+          {"noise", int(call_info.noise)},
+          {"source_num", int(call_info.source_num)},
+          {"recorder_num", int(call_info.recorder_num)},
+          {"tdma_slot", int(call_info.tdma_slot)},
+          {"phase2_tdma", int(call_info.phase2_tdma)},
+          {"start_time", call_info.start_time},
+          {"stop_time", call_info.stop_time},
+          {"emergency", int(call_info.emergency)},
+          {"priority", call_info.priority},
+          {"mode", int(call_info.mode)},
+          {"duplex", int(call_info.duplex)},
+          {"encrypted",int(call_info.encrypted)},
+          {"call_length", int(std::round(call_info.length))},
+          {"talkgroup", call_info.talkgroup},
+          {"talkgroup_tag", call_info.talkgroup_alpha_tag},
+          {"talkgroup_description", call_info.talkgroup_description},
+          {"talkgroup_group_tag", call_info.talkgroup_tag},
+          {"talkgroup_group", call_info.talkgroup_group},
+          {"color_code", call_info.color_code},
+          {"audio_type", call_info.audio_type},
+          {"short_name", call_info.short_name}
+        };
+  // Add any patched talkgroups
+  if (call_info.patched_talkgroups.size() > 1) {
+    for (std::size_t i = 0; i < call_info.patched_talkgroups.size(); i++) {
+      json_data["patched_talkgroups"] += int(call_info.patched_talkgroups[i]);
+    }
+  }
+  // Add frequencies / IMBE errors
+  for (std::size_t i = 0; i < call_info.transmission_error_list.size(); i++) {
+    json_data["freqList"] += {
+        {"freq", int(call_info.freq)},
+        {"time", call_info.transmission_error_list[i].time},
+        {"pos", call_info.transmission_error_list[i].position},
+        {"len", call_info.transmission_error_list[i].total_len},
+        {"error_count", int(call_info.transmission_error_list[i].error_count)},
+        {"spike_count", int(call_info.transmission_error_list[i].spike_count)}};
+  }
+  // Add sources / tags
+  for (std::size_t i = 0; i < call_info.transmission_source_list.size(); i++) {
+    json_data["srcList"] += {
+        {"src", int(call_info.transmission_source_list[i].source)},
+        {"time", call_info.transmission_source_list[i].time},
+        {"pos", call_info.transmission_source_list[i].position},
+        {"emergency", int(call_info.transmission_source_list[i].emergency)},
+        {"signal_system", call_info.transmission_source_list[i].signal_system},
+        {"tag", call_info.transmission_source_list[i].tag}};
+  }
+  return json_data;
+}
+
+void Call_Journal::init(Config &config) {
+  journal_dir = config.call_journal_dir;
+  journal_only = config.call_journal_only;
+
+  if (!enabled()) {
+    return;
+  }
+
+  boost::system::error_code ec;
+  boost::filesystem::create_directories(journal_dir, ec);
+  if (ec) {
+    BOOST_LOG_TRIVIAL(error) << "Unable to create Call Journal directory: " << journal_dir << " - " << ec.message();
+  }
+}
+
+// Called with journal_mutex held
+bool Call_Journal::open_journal(time_t now) {
+  char day[16];
+  struct tm local;
+  localtime_r(&now, &local);
+  strftime(day, sizeof(day), "%Y%m%d", &local);
+
+  if ((journal_fd >= 0) && (journal_day == day)) {
+    return true;
+  }
+
+  if (journal_fd >= 0) {
+    fdatasync(journal_fd);
+    ::close(journal_fd);
+    journal_fd = -1;
+  }
+
+  std::string path = journal_dir + "/calls-" + day + ".trj";
+  journal_fd = open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+  if (journal_fd < 0) {
+    BOOST_LOG_TRIVIAL(error) << "Unable to open Call Journal: " << path << " - " << strerror(errno);
+    return false;
+  }
+  journal_day = day;
+  unsynced_records = 0;
+  last_sync = now;
+
+  struct stat statbuf;
+  if ((fstat(journal_fd, &statbuf) == 0) && (statbuf.st_size == 0)) {
+    std::string header(JOURNAL_MAGIC, 4);
+    put_u32(header, VERSION);
+    if (write(journal_fd, header.data(), header.size()) != (ssize_t)header.size()) {
+      BOOST_LOG_TRIVIAL(error) << "Unable to write Call Journal header: " << path << " - " << strerror(errno);
+    }
+  }
+  return true;
+}
+
+void Call_Journal::append(const Call_Data_t &call_info) {
+  if (!enabled()) {
+    return;
+  }
+
+  // Encoded outside the lock, into a buffer each uploader thread keeps
+  thread_local std::string payload;
+  thread_local std::string record;
+  encode(call_info, payload);
+
+  boost::crc_32_type checksum;
+  checksum.process_bytes(payload.data(), payload.size());
+  record.clear();
+  put_u32(record, payload.size());
+  put_u32(record, checksum.checksum());
+  record.append(payload);
+
+  std::lock_guard<std::mutex> lock(journal_mutex);
+  time_t now = time(NULL);
+
+  if (!open_journal(now)) {
+    return;
+  }
+
+  // The reader stops at the first damaged record, so a record that can't be
+  // written in full is cut off again rather than left in front of the next one
+  off_t start = lseek(journal_fd, 0, SEEK_END);
+  size_t written = 0;
+  while (written < record.size()) {
+    ssize_t n = write(journal_fd, record.data() + written, record.size() - written);
+    if (n <= 0) {
+      if ((n < 0) && (errno == EINTR)) {
+        continue;
+      }
+      break;
+    }
+    written += n;
+  }
+
+  if (written < record.size()) {
+    int write_errno = errno;
+    std::string loghdr = log_header(call_info.short_name, call_info.call_num, call_info.talkgroup_display, call_info.freq);
+    BOOST_LOG_TRIVIAL(error) << loghdr << "Unable to write to Call Journal - " << strerror(write_errno);
+    if ((start < 0) || (ftruncate(journal_fd, start) != 0)) {
+      BOOST_LOG_TRIVIAL(error) << loghdr << "Unable to remove the partial Call Journal record, the rest of today's journal won't be readable - " << strerror(errno);
+    }
+    return;
+  }
+
+  unsynced_records++;
+  if ((unsynced_records >= SYNC_BATCH) || (now - last_sync >= 1)) {
+    fdatasync(journal_fd);
+    unsynced_records = 0;
+    last_sync = now;
+  }
+}
+
+void Call_Journal::close() {
+  std::lock_guard<std::mutex> lock(journal_mutex);
+
+  if (journal_fd >= 0) {
+    fdatasync(journal_fd);
+    ::close(journal_fd);
+    journal_fd = -1;
+  }
+}
@@ -0,0 +1,63 @@
+#ifndef CALL_JOURNAL_H
+#define CALL_JOURNAL_H
+
+#include <cstdint>
+#include <ctime>
+#include <istream>
+#include <mutex>
+#include <string>
+
+#include "../global_structs.h"
+
+/*
+ * Append-only journal of concluded calls, as an alternative to indexing one
+ * JSON file per call.
+ *
+ * Journals are rotated daily, as <callJournalDir>/calls-YYYYMMDD.trj. Each
+ * file starts with the 4 byte magic "TRCJ" and a uint32 version, followed by
+ * records of:
+ *
+ *   uint32 payload length
+ *   uint32 CRC-32 of the payload
+ *   payload
+ *
+ * All integers are little endian and doubles are IEEE 754 bit patterns. The
+ * payload holds the same Call_Data_t fields as the call JSON, including the
+ * srcList and freqList, in the order encode() writes them. A record that was
+ * cut short by a crash fails its length or CRC check, and readers stop there.
+ */
+class Call_Journal {
+
+public:
+  static const uint32_t VERSION;
+
+  static void init(Config &config);
+  static bool enabled() { return !journal_dir.empty(); }
+  static bool replaces_json_files() { return enabled() && journal_only; }
+  static void append(const Call_Data_t &call_info);
+  static void close();
+
+  static void encode(const Call_Data_t &call_info, std::string &record);
+  static bool decode(const std::string &payload, Call_Data_t &call_info);
+
+  // Reads the file header, then one record at a time. Both return false at
+  // the end of the journal or at the first damaged record.
+  static bool read_header(std::istream &in);
+  static bool read_record(std::istream &in, Call_Data_t &call_info);
+
+  // The call JSON that create_call_json writes
+  static nlohmann::ordered_json to_json(const Call_Data_t &call_info);
+
+private:
+  static std::string journal_dir;
+  static bool journal_only;
+  static std::mutex journal_mutex;
+  static int journal_fd;
+  static std::string journal_day;
+  static int unsynced_records;
+  static time_t last_sync;
+
+  static bool open_journal(time_t now);
+};
+
+#endif
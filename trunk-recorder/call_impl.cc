@@ -9,25 +9,25 @@
 #include <signal.h>
 #include <stdio.h>
 
-std::string Call_impl::get_capture_dir() {
-  return this->config.capture_dir;
+const std::string &Call_impl::get_capture_dir() {
+  return this->config->capture_dir;
 }
 
-std::string Call_impl::get_temp_dir() {
-  return this->config.temp_dir;
+const std::string &Call_impl::get_temp_dir() {
+  return this->config->temp_dir;
 }
 
 /*
-Call * Call::make(long t, double f, System *s, Config c) {
+Call * Call::make(long t, double f, System *s, Config *c) {
 
   return (Call *) new Call_impl(t, f, s, c);
 }*/
 
-Call *Call::make(TrunkMessage message, System *s, Config c) {
+Call *Call::make(TrunkMessage message, System *s, Config *c) {
   return (Call *)new Call_impl(message, s, c);
 }
 
-Call_impl::Call_impl(long t, double f, System *s, Config c) {
+Call_impl::Call_impl(long t, double f, System *s, Config *c) {
   config = c;
   call_num = call_counter++;
   noise = DB_UNSET;
@@ -60,7 +60,7 @@ Call_impl::Call_impl(long t, double f, System *s, Config c) {
   this->update_talkgroup_display();
 }
 
-Call_impl::Call_impl(TrunkMessage message, System *s, Config c) {
+Call_impl::Call_impl(TrunkMessage message, System *s, Config *c) {
   config = c;
   call_num = call_counter++;
   noise = DB_UNSET;
@@ -167,14 +167,14 @@ void Call_impl::conclude_call() {
       // Conventional DMR is recorded on two slots, so we need to conclude the call for each slot
       transmission_list = recorder->get_transmission_list(0);
       tdma_slot = 0;
-      Call_Concluder::conclude_call(this, sys, config);
+      Call_Concluder::conclude_call(this, sys, *config);
       transmission_list = recorder->get_transmission_list(1);
       tdma_slot = 1;
-      Call_Concluder::conclude_call(this, sys, config);
+      Call_Concluder::conclude_call(this, sys, *config);
     } else {
       // All other system types do not have multiple recorders
       transmission_list = this->get_recorder()->get_transmission_list();
-      Call_Concluder::conclude_call(this, sys, config);
+      Call_Concluder::conclude_call(this, sys, *config);
    }
 
   }
@@ -480,45 +480,51 @@ void Call_impl::update_talkgroup_display() {
   talkgroup_display = boost::lexical_cast<std::string>(formattedTalkgroup);
 }
 
-boost::property_tree::ptree Call_impl::get_stats() {
-  boost::property_tree::ptree call_node;
-  boost::property_tree::ptree freq_list_node;
-  boost::property_tree::ptree source_list_node;
-  call_node.put("id", boost::lexical_cast<std::string>(this->get_sys_num()) + "_" + boost::lexical_cast<std::string>(this->get_talkgroup()) + "_" + boost::lexical_cast<std::string>(this->get_start_time()));
-  call_node.put("callNum", this->get_call_num());
-  call_node.put("freq", this->get_freq());
-  call_node.put("sysNum", this->get_sys_num());
-  call_node.put("shortName", this->get_short_name());
-  call_node.put("talkgroup", this->get_talkgroup());
-  call_node.put("talkgrouptag", this->get_talkgroup_tag());
-  call_node.put("elapsed", this->elapsed());
+void Call_impl::write_stats(Json_Writer &writer) {
+  char id[64];
+  snprintf(id, sizeof(id), "%d_%ld_%ld", this->get_sys_num(), this->get_talkgroup(), (long)this->get_start_time());
+
+  writer.begin_object();
+  writer.put("id", id);
+  writer.put("callNum", this->get_call_num());
+  writer.put("freq", this->get_freq());
+  writer.put("sysNum", this->get_sys_num());
+  writer.put("shortName", this->get_short_name());
+  writer.put("talkgroup", this->get_talkgroup());
+  writer.put("talkgrouptag", this->get_talkgroup_tag());
+  writer.put("elapsed", this->elapsed());
   if (get_state() == RECORDING)
-    call_node.put("length", this->get_current_length());
+    writer.put("length", this->get_current_length());
   else
-    call_node.put("length", this->get_final_length());
-  call_node.put("state", this->get_state());
-  call_node.put("monState", this->get_monitoring_state());
-  call_node.put("phase2", this->get_phase2_tdma());
-  call_node.put("conventional", this->is_conventional());
-  call_node.put("encrypted", this->get_encrypted());
-  call_node.put("emergency", this->get_emergency());
-  call_node.put("priority", this->get_priority());
-  call_node.put("mode", this->get_mode());
-  call_node.put("duplex", this->get_duplex());
-  call_node.put("startTime", this->get_start_time());
-  call_node.put("stopTime", this->get_stop_time());
-  call_node.put("srcId", this->get_current_source_id());
+    writer.put("length", this->get_final_length());
+  writer.put("state", this->get_state());
+  writer.put("monState", this->get_monitoring_state());
+  writer.put("phase2", this->get_phase2_tdma());
+  writer.put("conventional", this->is_conventional());
+  writer.put("encrypted", this->get_encrypted());
+  writer.put("emergency", this->get_emergency());
+  writer.put("priority", this->get_priority());
+  writer.put("mode", this->get_mode());
+  writer.put("duplex", this->get_duplex());
+  writer.put("startTime", this->get_start_time());
+  writer.put("stopTime", this->get_stop_time());
+  writer.put("srcId", this->get_current_source_id());
 
   Recorder *recorder = this->get_recorder();
 
   if (recorder) {
-    call_node.put("recNum", recorder->get_num());
-    call_node.put("srcNum", recorder->get_source()->get_num());
-    call_node.put("recState", recorder->get_state());
-    call_node.put("analog", recorder->is_analog());
+    writer.put("recNum", recorder->get_num());
+    writer.put("srcNum", recorder->get_source()->get_num());
+    writer.put("recState", recorder->get_state());
+    writer.put("analog", recorder->is_analog());
   }
+  writer.end_object();
+}
 
-  return call_node;
+boost::property_tree::ptree Call_impl::get_stats() {
+  Json_Writer writer;
+  write_stats(writer);
+  return writer.to_ptree();
 }
 
 long Call_impl::call_counter = 0;
\ No newline at end of file
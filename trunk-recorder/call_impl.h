@@ -21,8 +21,8 @@ class System;
 
 class Call_impl : public Call {
 public:
-  Call_impl(long t, double f, System *s, Config c);
-  Call_impl(TrunkMessage message, System *s, Config c);
+  Call_impl(long t, double f, System *s, Config *c);
+  Call_impl(TrunkMessage message, System *s, Config *c);
 
   long get_call_num();
   virtual void restart_call();
@@ -37,8 +37,8 @@ public:
   double get_freq();
   int get_sys_num();
   std::string get_short_name();
-  std::string get_capture_dir();
-  std::string get_temp_dir();
+  const std::string &get_capture_dir();
+  const std::string &get_temp_dir();
   void set_freq(double f);
   long get_talkgroup();
 
@@ -84,6 +84,7 @@ public:
   std::string get_talkgroup_display();
   void set_talkgroup_tag(std::string tag);
   void clear_transmission_list();
+  void write_stats(Json_Writer &writer);
   boost::property_tree::ptree get_stats();
 
   std::string get_talkgroup_tag();
@@ -134,7 +135,7 @@ protected:
   int tdma_slot;
   double final_length;
 
-  Config config;
+  Config *config;
   Recorder *recorder;
   Recorder *debug_recorder;
   Recorder *sigmf_recorder;
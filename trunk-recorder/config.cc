@@ -4,6 +4,7 @@
  * Parameters: <#parameters#>
  */
 #include "./config.h"
+#include <thread>
 
 using json = nlohmann::json;
 
@@ -87,6 +88,18 @@ void setup_file_log(std::string log_dir, std::string log_color, std::string time
   }
 }
 
+// GNU Radio throws when a block is pinned to a core that doesn't exist
+static bool valid_cores(const std::vector<int> &cores, std::string key) {
+  unsigned int core_count = std::thread::hardware_concurrency();
+  for (std::vector<int>::const_iterator it = cores.begin(); it != cores.end(); ++it) {
+    if ((*it < 0) || ((core_count > 0) && ((unsigned int)*it >= core_count))) {
+      BOOST_LOG_TRIVIAL(error) << key << ": core " << *it << " doesn't exist, this machine has " << core_count << " cores";
+      return false;
+    }
+  }
+  return true;
+}
+
 bool load_config(string config_file, Config &config, gr::top_block_sptr &tb, std::vector<Source *> &sources, std::vector<System *> &systems) {
 
   string system_modulation;
@@ -201,6 +214,32 @@ bool load_config(string config_file, Config &config, gr::top_block_sptr &tb, std
     BOOST_LOG_TRIVIAL(info) << "Phase 1 Software Vocoder: " << config.soft_vocoder;
     config.enable_audio_streaming = data.value("audioStreaming", false);
     BOOST_LOG_TRIVIAL(info) << "Enable Audio Streaming: " << config.enable_audio_streaming;
+    config.fused_analog_demod = data.value("fusedAnalogDemod", false);
+    BOOST_LOG_TRIVIAL(info) << "Fused Analog Demod: " << config.fused_analog_demod;
+    config.recorder_preemption = data.value("recorderPreemption", false);
+    BOOST_LOG_TRIVIAL(info) << "Recorder Preemption: " << config.recorder_preemption;
+    config.pretune_recorders = data.value("pretuneRecorders", 0);
+    BOOST_LOG_TRIVIAL(info) << "Pre-tuned Recorders per Source: " << config.pretune_recorders;
+    config.metrics_port = data.value("metricsPort", 0);
+    BOOST_LOG_TRIVIAL(info) << "Metrics Port: " << config.metrics_port;
+    config.metrics_address = data.value("metricsAddress", "127.0.0.1");
+    BOOST_LOG_TRIVIAL(info) << "Metrics Address: " << config.metrics_address;
+    config.call_journal_dir = data.value("callJournalDir", "");
+    BOOST_LOG_TRIVIAL(info) << "Call Journal Directory: " << config.call_journal_dir;
+    config.call_journal_only = data.value("callJournalOnly", false);
+    BOOST_LOG_TRIVIAL(info) << "Call Journal Only: " << config.call_journal_only;
+    config.recorder_pool_port = data.value("recorderPoolPort", 0);
+    BOOST_LOG_TRIVIAL(info) << "Recorder Pool Port: " << config.recorder_pool_port;
+    config.recorder_pool_address = data.value("recorderPoolAddress", "127.0.0.1");
+    BOOST_LOG_TRIVIAL(info) << "Recorder Pool Address: " << config.recorder_pool_address;
+    config.recorder_pool_controller = data.value("recorderPoolController", "");
+    BOOST_LOG_TRIVIAL(info) << "Recorder Pool Controller: " << config.recorder_pool_controller;
+    config.state_snapshot_file = data.value("stateSnapshotFile", "");
+    BOOST_LOG_TRIVIAL(info) << "State Snapshot File: " << config.state_snapshot_file;
+    config.state_snapshot_interval = data.value("stateSnapshotInterval", 10);
+    BOOST_LOG_TRIVIAL(info) << "State Snapshot Interval: " << config.state_snapshot_interval;
+    config.block_stats_interval = data.value("blockStatsInterval", 0);
+    BOOST_LOG_TRIVIAL(info) << "Block Stats Interval: " << config.block_stats_interval;
     config.record_uu_v_calls = data.value("recordUUVCalls", true);
     BOOST_LOG_TRIVIAL(info) << "Record Unit to Unit Voice Calls: " << config.record_uu_v_calls;
     config.new_call_from_update = data.value("newCallFromUpdate", true);
@@ -442,6 +481,20 @@ bool load_config(string config_file, Config &config, gr::top_block_sptr &tb, std
       }
     }
 
+    // Digital recorders only build the demod chain for the modulations that are actually in use
+    config.qpsk_recorders = false;
+    config.fsk4_recorders = false;
+    for (vector<System *>::iterator it = systems.begin(); it != systems.end(); it++) {
+      System *system = *it;
+      if ((system->get_system_type() == "p25") || (system->get_system_type() == "smartnet") || (system->get_system_type() == "conventionalP25")) {
+        if (system->get_qpsk_mod()) {
+          config.qpsk_recorders = true;
+        } else {
+          config.fsk4_recorders = true;
+        }
+      }
+    }
+
     BOOST_LOG_TRIVIAL(info) << "\n\n-------------------------------------\nSOURCES\n-------------------------------------\n";
     for (json element : data["sources"]) {
 
@@ -451,8 +504,8 @@ bool load_config(string config_file, Config &config, gr::top_block_sptr &tb, std
         bool gain_set = false;
         std::string driver = element.value("driver", "");
 
-        if ((driver != "osmosdr") && (driver != "usrp") && (driver != "sigmf") && (driver != "iqfile")) {
-          BOOST_LOG_TRIVIAL(error) << "Driver specified in config.json not recognized, needs to be osmosdr, sigmf, iqfile or usrp";
+        if ((driver != "osmosdr") && (driver != "usrp") && (driver != "sigmf") && (driver != "iqfile") && (driver != "iqbus")) {
+          BOOST_LOG_TRIVIAL(error) << "Driver specified in config.json not recognized, needs to be osmosdr, sigmf, iqfile, iqbus or usrp";
           return false;
         }
 
@@ -476,6 +529,13 @@ bool load_config(string config_file, Config &config, gr::top_block_sptr &tb, std
             return false;
           }
           source = new Source(iq_file, center, rate, repeat, &config);
+        } else if (driver == "iqbus") {
+          string iq_bus = element.value("iqBus", "");
+          source = new Source(iq_bus, &config);
+          if (!source->get_src_block()) {
+            BOOST_LOG_TRIVIAL(error) << "Unable to attach to IQ Bus: " << iq_bus << " - start the trunk-recorder that publishes it first";
+            return false;
+          }
         } else {
 
           std::string device = element.value("device", "");
@@ -542,6 +602,14 @@ bool load_config(string config_file, Config &config, gr::top_block_sptr &tb, std
             source->set_signal_detector_threshold(element["signalDetectorThreshold"]);
           }
 
+          if (element.contains("signalDetectorInterval")) {
+            source->set_signal_detector_interval(element["signalDetectorInterval"]);
+          }
+
+          if (element.contains("signalDetectorSegments")) {
+            source->set_signal_detector_segments(element["signalDetectorSegments"]);
+          }
+
           source->set_autotune_source(autotune);
 
           if (element.contains("gainSettings")) {
@@ -619,14 +687,42 @@ bool load_config(string config_file, Config &config, gr::top_block_sptr &tb, std
             source->set_freq_corr(ppm);
           }
         }
+        if (element.contains("affinity")) {
+          std::vector<int> cores = element["affinity"].get<std::vector<int>>();
+          if (!valid_cores(cores, "affinity")) {
+            return false;
+          }
+          source->set_affinity(cores);
+        }
+        if (element.contains("recorderAffinity") && !element["recorderAffinity"].empty()) {
+          // Either a single list of cores, or a list of core groups
+          std::vector<std::vector<int>> core_groups;
+          if (element["recorderAffinity"][0].is_array()) {
+            core_groups = element["recorderAffinity"].get<std::vector<std::vector<int>>>();
+          } else {
+            core_groups.push_back(element["recorderAffinity"].get<std::vector<int>>());
+          }
+          for (std::vector<std::vector<int>>::iterator it = core_groups.begin(); it != core_groups.end(); ++it) {
+            if (!valid_cores(*it, "recorderAffinity")) {
+              return false;
+            }
+          }
+          source->set_recorder_affinity(core_groups);
+        }
+        source->set_realtime_priority(element.value("realtimePriority", 0));
+        std::string iq_bus = element.value("iqBus", "");
+        if ((driver != "iqbus") && (iq_bus != "")) {
+          BOOST_LOG_TRIVIAL(info) << "Publishing on IQ Bus: " << iq_bus;
+          if (!source->publish_iq_bus(tb, iq_bus)) {
+            return false;
+          }
+        }
         BOOST_LOG_TRIVIAL(info) << "Max Frequency: " << format_freq(source->get_max_hz());
         BOOST_LOG_TRIVIAL(info) << "Min Frequency: " << format_freq(source->get_min_hz());
         BOOST_LOG_TRIVIAL(info) << "Digital Recorders: " << element.value("digitalRecorders", 0);
         BOOST_LOG_TRIVIAL(info) << "SigMF Recorders: " << element.value("sigmfRecorders", 0);
         BOOST_LOG_TRIVIAL(info) << "Analog Recorders: " << element.value("analogRecorders", 0);
-        source->create_digital_recorders(tb, digital_recorders);
-        source->create_analog_recorders(tb, analog_recorders);
-        source->create_sigmf_recorders(tb, sigmf_recorders);
+        source->set_recorder_counts(digital_recorders, analog_recorders, sigmf_recorders);
         if (config.debug_recorder) {
           source->create_debug_recorder(tb, source_count);
         }
@@ -0,0 +1,235 @@
+#include "flowgraph_stats.h"
+#include "plugin_manager/plugin_manager.h"
+#include "recorders/recorder.h"
+#include "source.h"
+#include "systems/system_impl.h"
+#include <algorithm>
+#include <boost/log/trivial.hpp>
+#include <deque>
+#include <gnuradio/block_detail.h>
+#include <gnuradio/block_registry.h>
+#include <gnuradio/high_res_timer.h>
+#include <gnuradio/prefs.h>
+#include <iomanip>
+#include <sstream>
+
+int Flowgraph_Stats::interval = 0;
+gr::top_block_sptr Flowgraph_Stats::top_block;
+time_t Flowgraph_Stats::last_update = 0;
+std::string Flowgraph_Stats::edge_list = "";
+std::vector<Flowgraph_Stats::Tracked_Block> Flowgraph_Stats::blocks;
+
+static gr::block_sptr cast_to_block_sptr(gr::basic_block_sptr p) {
+#if GNURADIO_VERSION < 0x030900
+  return boost::dynamic_pointer_cast<gr::block, gr::basic_block>(p);
+#else
+  return std::dynamic_pointer_cast<gr::block, gr::basic_block>(p);
+#endif
+}
+
+static uint64_t items_in(gr::block_sptr block) {
+  return (block->detail() && (block->detail()->ninputs() > 0)) ? block->nitems_read(0) : 0;
+}
+
+static uint64_t items_out(gr::block_sptr block) {
+  return (block->detail() && (block->detail()->noutputs() > 0)) ? block->nitems_written(0) : 0;
+}
+
+static double work_time(gr::block_sptr block) {
+  return block->pc_work_time_total() / (double)gr::high_res_timer_tps();
+}
+
+void Flowgraph_Stats::init(Config &config, gr::top_block_sptr tb) {
+  interval = config.block_stats_interval;
+  top_block = tb;
+  last_update = time(NULL);
+
+  if (!enabled()) {
+    return;
+  }
+
+  // Thread CPU time, so a block waiting to be scheduled isn't counted as busy
+  gr::prefs::singleton()->set_bool("PerfCounters", "on", true);
+  gr::prefs::singleton()->set_string("PerfCounters", "clock", "thread");
+  BOOST_LOG_TRIVIAL(info) << "Block Stats: GNU Radio performance counters are on, reporting every " << interval << " seconds";
+}
+
+void Flowgraph_Stats::find_blocks(std::vector<Source *> &sources, std::vector<System *> &systems) {
+  // The flattened flow graph is only available as text, one edge a line:
+  // <src alias>:<port>-><dst alias>:<port>
+  std::map<std::string, std::vector<std::string>> downstream;
+  std::map<std::pair<std::string, int>, std::vector<std::string>> port_downstream;
+  std::vector<std::string> aliases;
+  std::istringstream lines(edge_list);
+  std::string line;
+
+  while (std::getline(lines, line)) {
+    size_t arrow = line.find("->");
+    if (arrow == std::string::npos) {
+      continue;
+    }
+    std::string src = line.substr(0, arrow);
+    std::string dst = line.substr(arrow + 2);
+    size_t src_colon = src.rfind(':');
+    size_t dst_colon = dst.rfind(':');
+    if ((src_colon == std::string::npos) || (dst_colon == std::string::npos)) {
+      continue;
+    }
+    int src_port = atoi(src.c_str() + src_colon + 1);
+    src.resize(src_colon);
+    dst.resize(dst_colon);
+
+    downstream[src].push_back(dst);
+    port_downstream[std::make_pair(src, src_port)].push_back(dst);
+    aliases.push_back(src);
+    aliases.push_back(dst);
+  }
+  std::sort(aliases.begin(), aliases.end());
+  aliases.erase(std::unique(aliases.begin(), aliases.end()), aliases.end());
+
+  // Everything downstream of a selector port belongs to what is connected to it
+  std::vector<std::pair<std::pair<std::string, int>, std::string>> roots;
+  for (std::vector<Source *>::iterator it = sources.begin(); it != sources.end(); ++it) {
+    Source *source = *it;
+    if (!source->get_recorder_selector()) {
+      continue;
+    }
+    std::string selector = source->get_recorder_selector()->alias();
+    std::vector<Recorder *> recorders = source->get_recorders();
+    for (std::vector<Recorder *>::iterator rec_it = recorders.begin(); rec_it != recorders.end(); ++rec_it) {
+      Recorder *recorder = *rec_it;
+      if (recorder->get_type() != DEBUG) {
+        roots.push_back(std::make_pair(std::make_pair(selector, recorder->get_selector_port()), recorder->get_type_string()));
+      }
+    }
+  }
+  for (std::vector<System *>::iterator it = systems.begin(); it != systems.end(); ++it) {
+    System_impl *sys = (System_impl *)*it;
+    for (std::vector<System_impl::Control_Channel_Slot>::iterator slot = sys->control_channel_slots.begin(); slot != sys->control_channel_slots.end(); ++slot) {
+      if (slot->source->get_recorder_selector()) {
+        roots.push_back(std::make_pair(std::make_pair(slot->source->get_recorder_selector()->alias(), slot->selector_port), std::string("Control Channel")));
+      }
+    }
+  }
+
+  std::map<std::string, std::string> groups;
+  for (std::vector<std::pair<std::pair<std::string, int>, std::string>>::iterator root = roots.begin(); root != roots.end(); ++root) {
+    std::deque<std::string> pending(port_downstream[root->first].begin(), port_downstream[root->first].end());
+    while (!pending.empty()) {
+      std::string alias = pending.front();
+      pending.pop_front();
+      if (groups.count(alias)) {
+        continue;
+      }
+      groups[alias] = root->second;
+      pending.insert(pending.end(), downstream[alias].begin(), downstream[alias].end());
+    }
+  }
+
+  blocks.clear();
+  for (std::vector<std::string>::iterator alias = aliases.begin(); alias != aliases.end(); ++alias) {
+    gr::block_sptr block;
+    try {
+      block = cast_to_block_sptr(gr::global_block_registry.block_lookup(pmt::intern(*alias)));
+    } catch (std::exception &e) {
+      BOOST_LOG_TRIVIAL(debug) << "Block Stats: unable to find block " << *alias << " - " << e.what();
+    }
+    if (!block) {
+      continue;
+    }
+
+    Tracked_Block tracked;
+    tracked.block = block;
+    tracked.group = groups.count(*alias) ? groups[*alias] : "Source";
+    tracked.work_time = work_time(block);
+    tracked.items_in = items_in(block);
+    tracked.items_out = items_out(block);
+    blocks.push_back(tracked);
+  }
+  BOOST_LOG_TRIVIAL(info) << "Block Stats: tracking " << blocks.size() << " blocks";
+}
+
+void Flowgraph_Stats::update(std::vector<Source *> &sources, std::vector<System *> &systems) {
+  if (!enabled()) {
+    return;
+  }
+  time_t now = time(NULL);
+  if (now - last_update < interval) {
+    return;
+  }
+  float time_diff = now - last_update;
+  last_update = now;
+
+  // The counters are read from where they are when the blocks are found, so
+  // the first report comes an interval later
+  std::string current_edge_list = top_block->edge_list();
+  if (current_edge_list != edge_list) {
+    edge_list = current_edge_list;
+    find_blocks(sources, systems);
+    return;
+  }
+
+  std::map<std::pair<std::string, std::string>, Block_Stats> totals;
+  std::map<std::pair<std::string, std::string>, int> input_count;
+
+  for (std::vector<Tracked_Block>::iterator it = blocks.begin(); it != blocks.end(); ++it) {
+    gr::block_sptr block = it->block;
+    double block_work_time = work_time(block);
+    uint64_t block_items_in = items_in(block);
+    uint64_t block_items_out = items_out(block);
+
+    std::pair<std::string, std::string> key = std::make_pair(it->group, block->name());
+    Block_Stats &stats = totals[key];
+    stats.group = it->group;
+    stats.block = block->name();
+    stats.count++;
+    stats.work_seconds += block_work_time - it->work_time;
+    stats.items_in += block_items_in - it->items_in;
+    stats.items_out += block_items_out - it->items_out;
+
+    int ninputs = block->detail() ? block->detail()->ninputs() : 0;
+    for (int i = 0; i < ninputs; i++) {
+      stats.input_full += block->pc_input_buffers_full_avg(i);
+      stats.input_full_max = std::max(stats.input_full_max, (double)block->pc_input_buffers_full(i));
+      input_count[key]++;
+    }
+
+    it->work_time = block_work_time;
+    it->items_in = block_items_in;
+    it->items_out = block_items_out;
+  }
+
+  std::vector<Block_Stats> stats;
+  for (std::map<std::pair<std::string, std::string>, Block_Stats>::iterator it = totals.begin(); it != totals.end(); ++it) {
+    if (input_count[it->first] > 0) {
+      it->second.input_full /= input_count[it->first];
+    }
+    stats.push_back(it->second);
+  }
+
+  // One line for each group: its share of a CPU, the block that used the most
+  // and the block whose input is closest to full
+  std::map<std::string, std::vector<Block_Stats *>> by_group;
+  for (std::vector<Block_Stats>::iterator it = stats.begin(); it != stats.end(); ++it) {
+    by_group[it->group].push_back(&*it);
+  }
+  for (std::map<std::string, std::vector<Block_Stats *>>::iterator it = by_group.begin(); it != by_group.end(); ++it) {
+    double group_work = 0;
+    Block_Stats *busiest = it->second[0];
+    Block_Stats *fullest = it->second[0];
+    for (std::vector<Block_Stats *>::iterator s = it->second.begin(); s != it->second.end(); ++s) {
+      group_work += (*s)->work_seconds;
+      if ((*s)->work_seconds > busiest->work_seconds) {
+        busiest = *s;
+      }
+      if ((*s)->input_full_max > fullest->input_full_max) {
+        fullest = *s;
+      }
+    }
+    BOOST_LOG_TRIVIAL(info) << "Block Stats: " << std::left << std::setw(16) << it->first << std::right << std::fixed << std::setprecision(1)
+                            << std::setw(6) << group_work / time_diff * 100 << "% CPU\tbusiest: " << busiest->block << " x" << busiest->count << " " << busiest->work_seconds / time_diff * 100
+                            << "%\tfullest input: " << fullest->block << " " << fullest->input_full_max * 100 << "%";
+  }
+
+  plugman_block_stats(stats, time_diff);
+}
@@ -0,0 +1,59 @@
+#ifndef FLOWGRAPH_STATS_H
+#define FLOWGRAPH_STATS_H
+
+#include <cstdint>
+#include <ctime>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <gnuradio/block.h>
+#include <gnuradio/top_block.h>
+
+#include "./global_structs.h"
+
+class Source;
+class System;
+
+/*
+ * Accounts for where the flow graph spends its time, to find the block that
+ * can't keep up when a Source overruns.
+ *
+ * Turning it on turns on the GNU Radio performance counters, measuring the
+ * thread CPU time each block spends in work(). Every blockStatsInterval
+ * seconds the counters of every block in the flattened top block are read
+ * and summed by the recorder type the block belongs to, Control Channel for
+ * the control channel decoders or Source for the blocks ahead of the
+ * recorders. The totals are logged and passed to plugins.
+ *
+ * A block is placed by following the flow graph from the selector port each
+ * recorder and control channel decoder is connected to.
+ */
+class Flowgraph_Stats {
+
+public:
+  // Has to be called before the top block is started, since the performance
+  // counters are only read when the scheduler starts
+  static void init(Config &config, gr::top_block_sptr tb);
+  static bool enabled() { return interval > 0; }
+  static void update(std::vector<Source *> &sources, std::vector<System *> &systems);
+
+private:
+  struct Tracked_Block {
+    gr::block_sptr block;
+    std::string group;
+    double work_time;
+    uint64_t items_in;
+    uint64_t items_out;
+  };
+
+  static int interval;
+  static gr::top_block_sptr top_block;
+  static time_t last_update;
+  static std::string edge_list;
+  static std::vector<Tracked_Block> blocks;
+
+  static void find_blocks(std::vector<Source *> &sources, std::vector<System *> &systems);
+};
+
+#endif
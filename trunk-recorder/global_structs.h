@@ -1,5 +1,6 @@
 #ifndef GLOBAL_STRUCTS_H
 #define GLOBAL_STRUCTS_H
+#include <cstdint>
 #include <ctime>
 #include <string>
 #include <vector>
@@ -45,7 +46,22 @@ struct Config {
   int control_retune_limit;
   bool broadcast_signals;
   bool enable_audio_streaming;
+  bool fused_analog_demod;
+  bool recorder_preemption;
+  int pretune_recorders;
+  int metrics_port;
+  std::string metrics_address;
+  std::string call_journal_dir;
+  bool call_journal_only;
+  int recorder_pool_port;
+  std::string recorder_pool_address;
+  std::string recorder_pool_controller;
+  std::string state_snapshot_file;
+  int state_snapshot_interval;
+  int block_stats_interval;
   bool soft_vocoder;
+  bool qpsk_recorders;
+  bool fsk4_recorders;
   bool record_uu_v_calls;
   bool archive_files_on_failure;
   int frequency_format;
@@ -60,6 +76,35 @@ struct Call_Source {
   std::string tag;
 };
 
+struct Pretune_Freq {
+  double freq;
+  bool qpsk_mod;
+  int priority;
+  time_t last_active;
+};
+
+struct Rejected_Talkgroup {
+  double freq;
+  time_t last_seen;
+  bool encrypted;
+};
+
+// Work done by the blocks of one kind in one group, a recorder type, Control
+// Channel or Source, since the last report
+struct Block_Stats {
+  std::string group;
+  std::string block;
+  int count = 0;
+  // thread CPU time spent in work(), summed over the blocks
+  double work_seconds = 0;
+  uint64_t items_in = 0;
+  uint64_t items_out = 0;
+  // how full the input buffers are, from 0 to 1: the average over time and
+  // inputs, and the fullest input on its last call to work()
+  double input_full = 0;
+  double input_full_max = 0;
+};
+
 struct Call_Freq {
   double freq;
   long time;
@@ -4,6 +4,7 @@
 #include <boost/log/trivial.hpp>
 #include <iomanip>
 
+#include "./filter_cache.h"
 #include "./rms_agc.h"
 #include "./pwr_squelch_cc.h"
 #include <gnuradio/blocks/copy.h>
@@ -148,6 +148,7 @@ signal_decoder_sink_impl::signal_decoder_sink_impl(unsigned int sample_rate, dec
     : sync_block("signal_decoder_sink_impl",
                  io_signature::make(1, 1, sizeof(float)),
                  io_signature::make(0, 0, 0)),
+      d_tone_gate(sample_rate),
       d_callback(callback),
       d_mdc_enabled(false),
       d_fsync_enabled(false),
@@ -178,16 +179,28 @@ int signal_decoder_sink_impl::work(int noutput_items, gr_vector_const_void_star
 
 int signal_decoder_sink_impl::dowork(int noutput_items, gr_vector_const_void_star &input_items, gr_vector_void_star &output_items) {
 
+  if (!d_mdc_enabled && !d_fsync_enabled && !d_star_enabled) {
+    return noutput_items;
+  }
+
+  // Only hand the decoders audio that looks like it has a signaling burst in it
+  const std::vector<float> &samples = d_tone_gate.process((const float *)input_items[0], noutput_items);
+  if (samples.empty()) {
+    return noutput_items;
+  }
+  float *audio = const_cast<float *>(&samples[0]);
+  int audio_len = samples.size();
+
   if (d_mdc_enabled) {
-    mdc_decoder_process_samples(d_mdc_decoder, (float *)input_items[0], noutput_items);
+    mdc_decoder_process_samples(d_mdc_decoder, audio, audio_len);
   }
 
   if (d_fsync_enabled) {
-    fsync_decoder_process_samples(d_fsync_decoder, (float *)input_items[0], noutput_items);
+    fsync_decoder_process_samples(d_fsync_decoder, audio, audio_len);
   }
 
   if (d_star_enabled) {
-    star_decoder_process_samples(d_star_decoder, (float *)input_items[0], noutput_items);
+    star_decoder_process_samples(d_star_decoder, audio, audio_len);
   }
 
   return noutput_items;
@@ -30,6 +30,7 @@
 #include "fsync_decode.h"
 #include "mdc_decode.h"
 #include "star_decode.h"
+#include "tone_gate.h"
 
 namespace gr {
 namespace blocks {
@@ -39,6 +40,7 @@ private:
   mdc_decoder_t *d_mdc_decoder;
   fsync_decoder_t *d_fsync_decoder;
   star_decoder_t *d_star_decoder;
+  tone_gate d_tone_gate;
   decoder_callback d_callback;
 
   bool d_mdc_enabled;
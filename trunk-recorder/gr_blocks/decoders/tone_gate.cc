@@ -0,0 +1,118 @@
+/*
+ * tone_gate.cc
+ *  cheap pre-detector for the FSK / PSK signaling bursts handled by the
+ *  MDC1200, FleetSync and STAR decoders
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "tone_gate.h"
+#include <algorithm>
+#include <cmath>
+
+#define TONE_GATE_BLOCK_MS 10
+#define TONE_GATE_PREROLL_MS 100
+#define TONE_GATE_HOLD_MS 300
+
+// fraction of a block's energy that has to be on the tones
+#define TONE_GATE_RATIO 0.25f
+
+// blocks quieter than this (mean square) are never candidates
+#define TONE_GATE_FLOOR 1e-6f
+
+static const float tone_gate_freqs[] = {1200.0, 1600.0, 1800.0, 2400.0};
+
+tone_gate::tone_gate(unsigned int sample_rate) {
+  d_block_len = std::max(1, (int)(sample_rate * TONE_GATE_BLOCK_MS / 1000));
+  d_preroll_blocks = TONE_GATE_PREROLL_MS / TONE_GATE_BLOCK_MS;
+  d_hold_blocks = TONE_GATE_HOLD_MS / TONE_GATE_BLOCK_MS;
+
+  for (int t = 0; t < num_tones; t++) {
+    d_coeff[t] = 2.0 * cos(2.0 * M_PI * tone_gate_freqs[t] / sample_rate);
+    d_s1[t] = 0;
+    d_s2[t] = 0;
+  }
+  d_energy = 0;
+  d_fill = 0;
+  d_last = 0;
+
+  d_history.assign((d_preroll_blocks + 1) * d_block_len, 0);
+  d_history_pos = 0;
+  d_unpassed_blocks = 0;
+  d_hold = 0;
+}
+
+// Finish the block that was just stored at d_history_pos and return whether
+// it is a candidate.
+bool tone_gate::end_block() {
+  float tone_power = 0;
+
+  for (int t = 0; t < num_tones; t++) {
+    tone_power += d_s1[t] * d_s1[t] + d_s2[t] * d_s2[t] - d_coeff[t] * d_s1[t] * d_s2[t];
+    d_s1[t] = 0;
+    d_s2[t] = 0;
+  }
+
+  // A steady tone of any amplitude gives tone_power == energy * block_len / 2
+  bool candidate = (d_energy >= TONE_GATE_FLOOR * d_block_len) &&
+                   (tone_power >= TONE_GATE_RATIO * d_energy * d_block_len / 2);
+  d_energy = 0;
+  d_fill = 0;
+  return candidate;
+}
+
+const std::vector<float> &tone_gate::process(const float *samples, int count) {
+  int history_blocks = d_preroll_blocks + 1;
+
+  d_out.clear();
+
+  for (int i = 0; i < count; i++) {
+    float x = samples[i] - d_last;
+    d_last = samples[i];
+
+    for (int t = 0; t < num_tones; t++) {
+      float s0 = x + d_coeff[t] * d_s1[t] - d_s2[t];
+      d_s2[t] = d_s1[t];
+      d_s1[t] = s0;
+    }
+    d_energy += x * x;
+    d_history[d_history_pos * d_block_len + d_fill] = samples[i];
+
+    if (++d_fill < d_block_len) {
+      continue;
+    }
+
+    if (end_block()) {
+      if (d_hold == 0) {
+        // opening, pass on the pre-roll first: the blocks after this one in
+        // the ring are the oldest. A hold that ended recently has already
+        // passed some of them on, and the decoders must not see them twice.
+        for (int b = history_blocks - d_unpassed_blocks; b < history_blocks; b++) {
+          int pos = (d_history_pos + b) % history_blocks;
+          d_out.insert(d_out.end(), &d_history[pos * d_block_len], &d_history[(pos + 1) * d_block_len]);
+        }
+      }
+      d_hold = d_hold_blocks;
+    } else if (d_hold > 0) {
+      d_hold--;
+    }
+
+    if (d_hold > 0) {
+      d_out.insert(d_out.end(), &d_history[d_history_pos * d_block_len], &d_history[(d_history_pos + 1) * d_block_len]);
+      d_unpassed_blocks = 0;
+    } else {
+      d_unpassed_blocks = std::min(d_unpassed_blocks + 1, d_preroll_blocks);
+    }
+    d_history_pos = (d_history_pos + 1) % history_blocks;
+  }
+
+  return d_out;
+}
@@ -0,0 +1,72 @@
+/*
+ * tone_gate.h
+ *  cheap pre-detector for the FSK / PSK signaling bursts handled by the
+ *  MDC1200, FleetSync and STAR decoders
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef _TONE_GATE_H_
+#define _TONE_GATE_H_
+
+#include <vector>
+
+/*
+ * Splits the audio into 10 ms blocks and runs a Goertzel filter on each of
+ * the signaling tones: 1200 / 1800 Hz (MDC1200, FleetSync), 2400 Hz
+ * (FleetSync II) and 1600 Hz (the STAR carrier). A block is a candidate when
+ * enough of its energy sits on those tones, which silence, noise and voice
+ * rarely manage.
+ *
+ * Only candidate blocks, plus a hold time after them, are passed on to the
+ * decoders. When the gate opens the last few blocks are passed on first, so
+ * the decoders still see the preamble and sync of a burst. Blocks that were
+ * already passed on during an earlier hold are never passed on again.
+ */
+class tone_gate {
+public:
+  tone_gate(unsigned int sample_rate);
+
+  // Takes the next input samples and returns the audio the decoders should
+  // see, which is empty while the gate is closed.
+  const std::vector<float> &process(const float *samples, int count);
+
+  bool is_open() const { return d_hold > 0; }
+
+private:
+  static const int num_tones = 4;
+
+  int d_block_len;
+  int d_preroll_blocks;
+  int d_hold_blocks;
+  float d_coeff[num_tones];
+
+  // Goertzel state and energy of the block being filled. Both are taken
+  // after a first difference, which keeps voice energy (mostly below 1 kHz)
+  // from swamping the tones.
+  float d_last;
+  float d_s1[num_tones];
+  float d_s2[num_tones];
+  float d_energy;
+  int d_fill;
+
+  // last d_preroll_blocks blocks, oldest first from d_history_pos
+  std::vector<float> d_history;
+  int d_history_pos;
+  // blocks in the ring, newest first, that have not been passed on
+  int d_unpassed_blocks;
+  int d_hold;
+  std::vector<float> d_out;
+
+  bool end_block();
+};
+
+#endif
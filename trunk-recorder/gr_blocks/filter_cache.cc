@@ -0,0 +1,87 @@
+#include "filter_cache.h"
+
+std::mutex filter_cache::cache_mutex;
+std::map<filter_cache::Design_Key, std::vector<float>> filter_cache::real_taps;
+std::map<filter_cache::Design_Key, std::vector<gr_complex>> filter_cache::complex_taps;
+long filter_cache::cache_hits = 0;
+long filter_cache::cache_misses = 0;
+
+const std::vector<float> &filter_cache::low_pass(double gain, double sampling_freq, double cutoff_freq, double transition_width, filter_window_t window, double beta) {
+  Design_Key key(LOW_PASS, gain, sampling_freq, cutoff_freq, 0, transition_width, 0, (int)window, beta);
+  std::lock_guard<std::mutex> lock(cache_mutex);
+
+  std::map<Design_Key, std::vector<float>>::iterator it = real_taps.find(key);
+  if (it != real_taps.end()) {
+    cache_hits++;
+    return it->second;
+  }
+  cache_misses++;
+  return real_taps[key] = gr::filter::firdes::low_pass(gain, sampling_freq, cutoff_freq, transition_width, window, beta);
+}
+
+const std::vector<float> &filter_cache::low_pass_2(double gain, double sampling_freq, double cutoff_freq, double transition_width, double attenuation_db, filter_window_t window, double beta) {
+  Design_Key key(LOW_PASS_2, gain, sampling_freq, cutoff_freq, 0, transition_width, attenuation_db, (int)window, beta);
+  std::lock_guard<std::mutex> lock(cache_mutex);
+
+  std::map<Design_Key, std::vector<float>>::iterator it = real_taps.find(key);
+  if (it != real_taps.end()) {
+    cache_hits++;
+    return it->second;
+  }
+  cache_misses++;
+  return real_taps[key] = gr::filter::firdes::low_pass_2(gain, sampling_freq, cutoff_freq, transition_width, attenuation_db, window, beta);
+}
+
+const std::vector<float> &filter_cache::high_pass(double gain, double sampling_freq, double cutoff_freq, double transition_width, filter_window_t window, double beta) {
+  Design_Key key(HIGH_PASS, gain, sampling_freq, cutoff_freq, 0, transition_width, 0, (int)window, beta);
+  std::lock_guard<std::mutex> lock(cache_mutex);
+
+  std::map<Design_Key, std::vector<float>>::iterator it = real_taps.find(key);
+  if (it != real_taps.end()) {
+    cache_hits++;
+    return it->second;
+  }
+  cache_misses++;
+  return real_taps[key] = gr::filter::firdes::high_pass(gain, sampling_freq, cutoff_freq, transition_width, window, beta);
+}
+
+const std::vector<gr_complex> &filter_cache::complex_band_pass(double gain, double sampling_freq, double low_cutoff_freq, double high_cutoff_freq, double transition_width, filter_window_t window, double beta) {
+  Design_Key key(COMPLEX_BAND_PASS, gain, sampling_freq, low_cutoff_freq, high_cutoff_freq, transition_width, 0, (int)window, beta);
+  std::lock_guard<std::mutex> lock(cache_mutex);
+
+  std::map<Design_Key, std::vector<gr_complex>>::iterator it = complex_taps.find(key);
+  if (it != complex_taps.end()) {
+    cache_hits++;
+    return it->second;
+  }
+  cache_misses++;
+  return complex_taps[key] = gr::filter::firdes::complex_band_pass(gain, sampling_freq, low_cutoff_freq, high_cutoff_freq, transition_width, window, beta);
+}
+
+const std::vector<gr_complex> &filter_cache::complex_band_pass_2(double gain, double sampling_freq, double low_cutoff_freq, double high_cutoff_freq, double transition_width, double attenuation_db, filter_window_t window, double beta) {
+  Design_Key key(COMPLEX_BAND_PASS_2, gain, sampling_freq, low_cutoff_freq, high_cutoff_freq, transition_width, attenuation_db, (int)window, beta);
+  std::lock_guard<std::mutex> lock(cache_mutex);
+
+  std::map<Design_Key, std::vector<gr_complex>>::iterator it = complex_taps.find(key);
+  if (it != complex_taps.end()) {
+    cache_hits++;
+    return it->second;
+  }
+  cache_misses++;
+  return complex_taps[key] = gr::filter::firdes::complex_band_pass_2(gain, sampling_freq, low_cutoff_freq, high_cutoff_freq, transition_width, attenuation_db, window, beta);
+}
+
+size_t filter_cache::size() {
+  std::lock_guard<std::mutex> lock(cache_mutex);
+  return real_taps.size() + complex_taps.size();
+}
+
+long filter_cache::hits() {
+  std::lock_guard<std::mutex> lock(cache_mutex);
+  return cache_hits;
+}
+
+long filter_cache::misses() {
+  std::lock_guard<std::mutex> lock(cache_mutex);
+  return cache_misses;
+}
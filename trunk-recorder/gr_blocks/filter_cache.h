@@ -0,0 +1,56 @@
+#ifndef FILTER_CACHE_H
+#define FILTER_CACHE_H
+
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+#include <gnuradio/filter/firdes.h>
+#include <gnuradio/gr_complex.h>
+
+#if GNURADIO_VERSION < 0x030900
+typedef gr::filter::firdes::win_type filter_window_t;
+#else
+typedef gr::fft::window::win_type filter_window_t;
+#endif
+
+/*
+ * Process-wide cache of FIR tap designs.
+ *
+ * Every recorder on a Source builds its channelizer and demod filters with the
+ * same parameters, so designing them once and handing out copies avoids
+ * re-running firdes (Kaiser windows and the low_pass_2 attenuation search are
+ * not cheap) for each of the dozens of recorders created at startup. The
+ * returned references stay valid for the life of the process.
+ */
+class filter_cache {
+public:
+  static const std::vector<float> &low_pass(double gain, double sampling_freq, double cutoff_freq, double transition_width, filter_window_t window = filter_window_t::WIN_HAMMING, double beta = 6.76);
+  static const std::vector<float> &low_pass_2(double gain, double sampling_freq, double cutoff_freq, double transition_width, double attenuation_db, filter_window_t window = filter_window_t::WIN_HAMMING, double beta = 6.76);
+  static const std::vector<float> &high_pass(double gain, double sampling_freq, double cutoff_freq, double transition_width, filter_window_t window = filter_window_t::WIN_HAMMING, double beta = 6.76);
+  static const std::vector<gr_complex> &complex_band_pass(double gain, double sampling_freq, double low_cutoff_freq, double high_cutoff_freq, double transition_width, filter_window_t window = filter_window_t::WIN_HAMMING, double beta = 6.76);
+  static const std::vector<gr_complex> &complex_band_pass_2(double gain, double sampling_freq, double low_cutoff_freq, double high_cutoff_freq, double transition_width, double attenuation_db, filter_window_t window = filter_window_t::WIN_HAMMING, double beta = 6.76);
+
+  static size_t size();
+  static long hits();
+  static long misses();
+
+private:
+  enum Design_Type { LOW_PASS,
+                     LOW_PASS_2,
+                     HIGH_PASS,
+                     COMPLEX_BAND_PASS,
+                     COMPLEX_BAND_PASS_2 };
+
+  // type, gain, rate, low/cutoff, high, transition, attenuation, window, beta
+  typedef std::tuple<int, double, double, double, double, double, double, int, double> Design_Key;
+
+  static std::mutex cache_mutex;
+  static std::map<Design_Key, std::vector<float>> real_taps;
+  static std::map<Design_Key, std::vector<gr_complex>> complex_taps;
+  static long cache_hits;
+  static long cache_misses;
+};
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef INCLUDED_GR_FM_AUDIO_DEMOD_H
+#define INCLUDED_GR_FM_AUDIO_DEMOD_H
+
+#include <gnuradio/block.h>
+#include <gnuradio/blocks/api.h>
+#include <vector>
+
+namespace gr {
+namespace blocks {
+
+/*!
+ * \brief Single-pass FM audio chain for analog_recorder.
+ * \ingroup level_controllers_blk
+ *
+ * \details
+ * Runs quadrature demod, de-emphasis, the decimating audio filter, the
+ * 300 - 3000 Hz band pass, the trailing power gate, level scaling and the
+ * conversion to 16 bit samples over each buffer in one block, instead of
+ * handing the samples through eight separate blocks.
+ *
+ * Output 0 is the decimated audio ahead of the band pass (float), which feeds
+ * the signaling decoders. Output 1 is the gated and scaled audio (int16),
+ * which feeds the transmission and plugin sinks.
+ */
+class BLOCKS_API fm_audio_demod : virtual public block {
+public:
+#if GNURADIO_VERSION < 0x030900
+  typedef boost::shared_ptr<fm_audio_demod> sptr;
+#else
+  typedef std::shared_ptr<fm_audio_demod> sptr;
+#endif
+
+  /*!
+   * \param quad_gain gain of the quadrature demod
+   * \param fftaps feed forward taps of the first order de-emphasis filter
+   * \param fbtaps feed back taps of the de-emphasis filter, fbtaps[0] == 1
+   * \param decimation decimation of the audio filter
+   * \param decim_taps taps of the decimating audio filter
+   * \param high_taps taps of the high pass half of the band pass
+   * \param low_taps taps of the low pass half of the band pass
+   * \param level multiplier applied to the band passed audio
+   * \param gate_db power (dB) below which band passed audio is dropped
+   * \param gate_alpha gain of the power averaging filter for the gate
+   */
+  static sptr make(float quad_gain,
+                   const std::vector<double> &fftaps,
+                   const std::vector<double> &fbtaps,
+                   int decimation,
+                   const std::vector<float> &decim_taps,
+                   const std::vector<float> &high_taps,
+                   const std::vector<float> &low_taps,
+                   float level,
+                   double gate_db,
+                   double gate_alpha);
+
+  virtual void set_gain(float quad_gain) = 0;
+  virtual void set_deemph_taps(const std::vector<double> &fftaps, const std::vector<double> &fbtaps) = 0;
+  virtual void set_level(float level) = 0;
+};
+
+} /* namespace blocks */
+} /* namespace gr */
+
+#endif /* INCLUDED_GR_FM_AUDIO_DEMOD_H */
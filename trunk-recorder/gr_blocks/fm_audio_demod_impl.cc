@@ -0,0 +1,172 @@
+#include "fm_audio_demod_impl.h"
+#include <algorithm>
+#include <cmath>
+#include <gnuradio/io_signature.h>
+#include <volk/volk.h>
+
+namespace gr {
+namespace blocks {
+
+fm_audio_demod::sptr
+fm_audio_demod::make(float quad_gain,
+                     const std::vector<double> &fftaps,
+                     const std::vector<double> &fbtaps,
+                     int decimation,
+                     const std::vector<float> &decim_taps,
+                     const std::vector<float> &high_taps,
+                     const std::vector<float> &low_taps,
+                     float level,
+                     double gate_db,
+                     double gate_alpha) {
+  return gnuradio::get_initial_sptr(new fm_audio_demod_impl(quad_gain, fftaps, fbtaps, decimation, decim_taps, high_taps, low_taps, level, gate_db, gate_alpha));
+}
+
+std::vector<float> fm_audio_demod_impl::reverse_taps(const std::vector<float> &taps) {
+  std::vector<float> reversed(taps.rbegin(), taps.rend());
+  if (reversed.empty()) {
+    reversed.push_back(1.0);
+  }
+  return reversed;
+}
+
+fm_audio_demod_impl::fm_audio_demod_impl(float quad_gain,
+                                         const std::vector<double> &fftaps,
+                                         const std::vector<double> &fbtaps,
+                                         int decimation,
+                                         const std::vector<float> &decim_taps,
+                                         const std::vector<float> &high_taps,
+                                         const std::vector<float> &low_taps,
+                                         float level,
+                                         double gate_db,
+                                         double gate_alpha)
+    : block("fm_audio_demod",
+            io_signature::make(1, 1, sizeof(gr_complex)),
+            io_signature::make2(2, 2, sizeof(float), sizeof(int16_t))),
+      d_gain(quad_gain),
+      d_decim(std::max(decimation, 1)),
+      d_level(level),
+      d_gate_threshold(std::pow(10.0, gate_db / 10)),
+      d_gate_alpha(gate_alpha),
+      d_gate_pwr(0),
+      d_deemph_x1(0),
+      d_deemph_y1(0),
+      d_last_sample(0, 0),
+      d_decim_taps(reverse_taps(decim_taps)),
+      d_high_taps(reverse_taps(high_taps)),
+      d_low_taps(reverse_taps(low_taps)) {
+  set_deemph_taps(fftaps, fbtaps);
+  set_relative_rate(1.0 / d_decim);
+
+  d_audio.assign(d_decim_taps.size() - 1, 0);
+  d_high_in.assign(d_high_taps.size() - 1, 0);
+  d_low_in.assign(d_low_taps.size() - 1, 0);
+}
+
+void fm_audio_demod_impl::set_gain(float quad_gain) {
+  gr::thread::scoped_lock guard(d_setlock);
+  d_gain = quad_gain;
+}
+
+void fm_audio_demod_impl::set_deemph_taps(const std::vector<double> &fftaps, const std::vector<double> &fbtaps) {
+  gr::thread::scoped_lock guard(d_setlock);
+  // Same convention as iir_filter_ffd with oldstyle = false
+  d_ff0 = fftaps.size() > 0 ? fftaps[0] : 1.0;
+  d_ff1 = fftaps.size() > 1 ? fftaps[1] : 0.0;
+  d_fb1 = fbtaps.size() > 1 ? fbtaps[1] : 0.0;
+}
+
+void fm_audio_demod_impl::set_level(float level) {
+  gr::thread::scoped_lock guard(d_setlock);
+  d_level = level;
+}
+
+void fm_audio_demod_impl::forecast(int noutput_items, gr_vector_int &ninput_items_required) {
+  ninput_items_required[0] = noutput_items * d_decim;
+}
+
+int fm_audio_demod_impl::general_work(int noutput_items,
+                                      gr_vector_int &ninput_items,
+                                      gr_vector_const_void_star &input_items,
+                                      gr_vector_void_star &output_items) {
+  gr::thread::scoped_lock guard(d_setlock);
+
+  const gr_complex *in = (const gr_complex *)input_items[0];
+  float *audio_out = (float *)output_items[0];
+  int16_t *wav_out = (int16_t *)output_items[1];
+
+  int nout = std::min(noutput_items, ninput_items[0] / d_decim);
+  if (nout <= 0) {
+    return 0;
+  }
+  int nin = nout * d_decim;
+
+  size_t decim_hist = d_decim_taps.size() - 1;
+  size_t high_hist = d_high_taps.size() - 1;
+  size_t low_hist = d_low_taps.size() - 1;
+
+  // FM discriminator, written straight after the decimator's history
+  d_product.resize(nin);
+  d_audio.resize(decim_hist + nin);
+  d_product[0] = in[0] * std::conj(d_last_sample);
+  if (nin > 1) {
+    volk_32fc_x2_multiply_conjugate_32fc(&d_product[1], in + 1, in, nin - 1);
+  }
+  d_last_sample = in[nin - 1];
+  float *demod = &d_audio[decim_hist];
+  volk_32fc_s32f_atan2_32f(demod, &d_product[0], 1.0 / d_gain, nin);
+
+  // De-emphasis, in place
+  for (int i = 0; i < nin; i++) {
+    double x = demod[i];
+    double y = d_ff0 * x + d_ff1 * d_deemph_x1 - d_fb1 * d_deemph_y1;
+    d_deemph_x1 = x;
+    d_deemph_y1 = y;
+    demod[i] = (float)y;
+  }
+
+  // Decimating audio filter. Its output is output 0 and the band pass input.
+  d_high_in.resize(high_hist + nout);
+  for (int i = 0; i < nout; i++) {
+    volk_32f_x2_dot_prod_32f(&audio_out[i], &d_audio[i * d_decim], &d_decim_taps[0], d_decim_taps.size());
+  }
+  std::copy(d_audio.begin() + nin, d_audio.end(), d_audio.begin());
+  std::copy(audio_out, audio_out + nout, d_high_in.begin() + high_hist);
+
+  // 300 Hz high pass, then 3000 Hz low pass
+  d_low_in.resize(low_hist + nout);
+  for (int i = 0; i < nout; i++) {
+    volk_32f_x2_dot_prod_32f(&d_low_in[low_hist + i], &d_high_in[i], &d_high_taps[0], d_high_taps.size());
+  }
+  std::copy(d_high_in.begin() + nout, d_high_in.end(), d_high_in.begin());
+
+  // Power gate on the band passed audio, as pwr_squelch_ff with no ramp and
+  // gate set, then the level multiplier
+  d_gated.resize(nout);
+  int ngated = 0;
+  for (int i = 0; i < nout; i++) {
+    float sample;
+    volk_32f_x2_dot_prod_32f(&sample, &d_low_in[i], &d_low_taps[0], d_low_taps.size());
+    d_gate_pwr = d_gate_alpha * (sample * sample) + (1.0 - d_gate_alpha) * d_gate_pwr;
+    if (d_gate_pwr >= d_gate_threshold) {
+      d_gated[ngated++] = sample * d_level;
+    }
+  }
+  std::copy(d_low_in.begin() + nout, d_low_in.end(), d_low_in.begin());
+
+  d_audio.resize(decim_hist);
+  d_high_in.resize(high_hist);
+  d_low_in.resize(low_hist);
+
+  // Same conversion float_to_short does
+  if (ngated > 0) {
+    volk_32f_s32f_convert_16i(wav_out, &d_gated[0], 32767, ngated);
+  }
+
+  consume_each(nin);
+  produce(0, nout);
+  produce(1, ngated);
+  return WORK_CALLED_PRODUCE;
+}
+
+} /* namespace blocks */
+} /* namespace gr */
@@ -0,0 +1,66 @@
+#ifndef INCLUDED_GR_FM_AUDIO_DEMOD_IMPL_H
+#define INCLUDED_GR_FM_AUDIO_DEMOD_IMPL_H
+
+#include "fm_audio_demod.h"
+#include <gnuradio/gr_complex.h>
+
+namespace gr {
+namespace blocks {
+
+class fm_audio_demod_impl : public fm_audio_demod {
+private:
+  float d_gain;
+  int d_decim;
+  float d_level;
+  double d_gate_threshold;
+  double d_gate_alpha;
+  double d_gate_pwr;
+
+  // de-emphasis: y[n] = ff0 * x[n] + ff1 * x[n-1] - fb1 * y[n-1]
+  double d_ff0, d_ff1, d_fb1;
+  double d_deemph_x1, d_deemph_y1;
+  gr_complex d_last_sample;
+
+  // Taps are stored reversed, the way gr::filter::kernel::fir_filter does,
+  // so each output is a straight dot product over the history buffer.
+  std::vector<float> d_decim_taps;
+  std::vector<float> d_high_taps;
+  std::vector<float> d_low_taps;
+
+  // Working buffers. Each filter's input buffer starts with ntaps - 1 samples
+  // carried over from the previous call.
+  std::vector<gr_complex> d_product;
+  std::vector<float> d_audio;
+  std::vector<float> d_high_in;
+  std::vector<float> d_low_in;
+  std::vector<float> d_gated;
+
+  static std::vector<float> reverse_taps(const std::vector<float> &taps);
+
+public:
+  fm_audio_demod_impl(float quad_gain,
+                      const std::vector<double> &fftaps,
+                      const std::vector<double> &fbtaps,
+                      int decimation,
+                      const std::vector<float> &decim_taps,
+                      const std::vector<float> &high_taps,
+                      const std::vector<float> &low_taps,
+                      float level,
+                      double gate_db,
+                      double gate_alpha);
+
+  void set_gain(float quad_gain);
+  void set_deemph_taps(const std::vector<double> &fftaps, const std::vector<double> &fbtaps);
+  void set_level(float level);
+
+  void forecast(int noutput_items, gr_vector_int &ninput_items_required);
+  int general_work(int noutput_items,
+                   gr_vector_int &ninput_items,
+                   gr_vector_const_void_star &input_items,
+                   gr_vector_void_star &output_items);
+};
+
+} /* namespace blocks */
+} /* namespace gr */
+
+#endif /* INCLUDED_GR_FM_AUDIO_DEMOD_IMPL_H */
@@ -48,7 +48,6 @@ selector_impl::selector_impl(size_t itemsize,
       d_got_samples(true),
       d_num_outputs(0) {
 
-  d_enabled_output_ports = std::vector<bool>(d_max_port, false);
   // TODO: add message ports for input_index and output_index
 }
 
@@ -79,12 +78,12 @@ void selector_impl::set_output_index(unsigned int output_index) {
   if (output_index < 0)
     throw std::out_of_range("input_index must be >= 0");
 
-  if (output_index < d_max_port)
-    d_output_index = output_index;
-  else
-    throw std::out_of_range("output_index must be < noutputs");
+  d_output_index = output_index;
+  if (output_index >= d_enabled_output_ports.size()) {
+    d_enabled_output_ports.resize(output_index + 1, false);
+  }
 
-  for (unsigned int out_idx = 0; out_idx < d_max_port; out_idx++) {
+  for (unsigned int out_idx = 0; out_idx < d_enabled_output_ports.size(); out_idx++) {
     if (output_index == out_idx) {
       d_enabled_output_ports[out_idx] = true;
     } else {
@@ -102,8 +101,12 @@ void selector_impl::forecast(int noutput_items, gr_vector_int &ninput_items_requ
 
 bool selector_impl::check_topology(int ninputs, int noutputs) {
   if ((int)d_input_index < ninputs && (int)d_output_index < noutputs) {
+    gr::thread::scoped_lock l(d_mutex);
     d_num_inputs = (unsigned int)ninputs;
     d_num_outputs = (unsigned int)noutputs;
+    if (d_num_outputs > d_enabled_output_ports.size()) {
+      d_enabled_output_ports.resize(d_num_outputs, false);
+    }
     return true;
   } else {
     GR_LOG_WARN(d_logger,
@@ -113,22 +116,18 @@ bool selector_impl::check_topology(int ninputs, int noutputs) {
 }
 
 void selector_impl::set_port_enabled(unsigned int port, bool enabled) {
-  if (port >= d_max_port) {
-    BOOST_LOG_TRIVIAL(info) << "disable_output_port() - Port: " << port << " is greater than max port of: " << d_max_port;
-    return;
-  }
-
   gr::thread::scoped_lock l(d_mutex);
+  if (port >= d_enabled_output_ports.size()) {
+    d_enabled_output_ports.resize(port + 1, false);
+  }
   d_enabled_output_ports[port] = enabled;
 }
 
 bool selector_impl::is_port_enabled(unsigned int port) {
-  if (port >= d_max_port) {
-    BOOST_LOG_TRIVIAL(info) << "disable_output_port() - Port: " << port << " is greater than max port of: " << d_max_port;
+  gr::thread::scoped_lock l(d_mutex);
+  if (port >= d_enabled_output_ports.size()) {
     return false;
   }
-
-  gr::thread::scoped_lock l(d_mutex);
   return d_enabled_output_ports[port];
 }
 
@@ -146,7 +145,7 @@ int selector_impl::general_work(int noutput_items,
   }
 
   for (size_t out_idx = 0; out_idx < output_items.size(); out_idx++) {
-    if (d_enabled_output_ports[out_idx]) {
+    if ((out_idx < d_enabled_output_ports.size()) && d_enabled_output_ports[out_idx]) {
       std::copy(in[d_input_index],
                 in[d_input_index] + noutput_items * d_itemsize,
                 out[out_idx]);
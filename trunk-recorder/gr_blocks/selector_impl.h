@@ -35,10 +35,11 @@ private:
   size_t d_itemsize;
   bool d_enabled;
   bool d_got_samples;
+  // Grows as ports are connected or enabled, so there is no limit on how
+  // many recorders and control channel decoders a Source can have
   std::vector<bool> d_enabled_output_ports;
   unsigned int d_input_index, d_output_index;
   unsigned int d_num_inputs, d_num_outputs; // keep track of the topology
-  const unsigned int d_max_port = 100;
   gr::thread::mutex d_mutex;
 
 
@@ -122,6 +122,18 @@ public:
     virtual void set_sensitivity(float d_sensitivity) = 0;
     virtual void set_auto_threshold(bool d_auto_threshold) = 0;
     virtual void set_average(float d_average) = 0;
+
+    /*!
+     * Seconds of input between detection updates. Only the vectors needed for
+     * the FFT segments of each interval are processed, the rest are skipped.
+     */
+    virtual void set_detection_interval(double interval) = 0;
+
+    /*!
+     * Number of FFTs, spread evenly across each interval, that are Welch
+     * averaged into the PSD used for a detection update.
+     */
+    virtual void set_segments(int segments) = 0;
 };
 
 //} // namespace inspector
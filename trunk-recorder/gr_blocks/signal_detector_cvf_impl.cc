@@ -23,6 +23,7 @@
 #endif
 
 #include "signal_detector_cvf_impl.h"
+#include <algorithm>
 #include <cmath>
 #include <gnuradio/io_signature.h>
 #include <volk/volk.h>
@@ -55,11 +56,6 @@ signal_detector_cvf::sptr signal_detector_cvf::make(double samp_rate,
                                                                  filename));
 }
 
-uint64_t signal_detector_cvf_impl::time_since_epoch_millisec() {
-  using namespace std::chrono;
-  return duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
-}
-
 /*
  * The private constructor
  */
@@ -96,24 +92,15 @@ signal_detector_cvf_impl::signal_detector_cvf_impl(double samp_rate,
   d_max_bw = max_bw;
   d_filename = filename;
   d_detected_signals = std::vector<Detected_Signal>();
-  last_conventional_channel_detection_check = time_since_epoch_millisec();
+  d_interval = 0.1;
+  d_segments = 1;
+  build_duty_cycle();
 
 
   BOOST_LOG_TRIVIAL(info) << "signal_detector_cvf_impl: " << "samp_rate: " << samp_rate << " fft_len: " << fft_len << " window_type: " << window_type << " threshold: " << threshold << " sensitivity: " << sensitivity << " auto_threshold: " << auto_threshold << " average: " << average << " quantization: " << quantization << " min_bw: " << min_bw << " filename: " << filename;
   BOOST_LOG_TRIVIAL(info) << "signal_detector_cvf_impl: " << "FFT Bucket Size: " << samp_rate / fft_len << " Hz Quatization: " << (int)floor(d_quantization * d_samp_rate);
   // allocate buffers
-  d_tmpbuf =
-      static_cast<float *>(volk_malloc(sizeof(float) * d_fft_len, volk_get_alignment()));
-  d_tmp_pxx =
-      static_cast<float *>(volk_malloc(sizeof(float) * d_fft_len, volk_get_alignment()));
-  d_pxx =
-      static_cast<float *>(volk_malloc(sizeof(float) * d_fft_len, volk_get_alignment()));
-  d_pxx_out = (float *)volk_malloc(sizeof(float) * d_fft_len, volk_get_alignment());
-#if GNURADIO_VERSION < 0x030900
-  d_fft = new gr::fft::fft_complex(fft_len, true);
-#else
-  d_fft = new gr::fft::fft_complex_fwd(fft_len, true);
-#endif
+  allocate_buffers();
 
   d_avg_filter.resize(d_fft_len);
   build_window();
@@ -130,29 +117,60 @@ signal_detector_cvf_impl::signal_detector_cvf_impl(double samp_rate,
  */
 signal_detector_cvf_impl::~signal_detector_cvf_impl() {
   // logfile.close();
+  free_buffers();
+}
+
+void signal_detector_cvf_impl::allocate_buffers() {
+  d_tmpbuf = static_cast<float *>(volk_malloc(sizeof(float) * d_fft_len, volk_get_alignment()));
+  d_tmp_pxx = static_cast<float *>(volk_malloc(sizeof(float) * d_fft_len, volk_get_alignment()));
+  d_pxx = static_cast<float *>(volk_malloc(sizeof(float) * d_fft_len, volk_get_alignment()));
+  d_pxx_out = (float *)volk_malloc(sizeof(float) * d_fft_len, volk_get_alignment());
+  d_welch_sum = (float *)volk_malloc(sizeof(float) * d_fft_len, volk_get_alignment());
+  d_mag = (float *)volk_malloc(sizeof(float) * d_fft_len, volk_get_alignment());
+#if GNURADIO_VERSION < 0x030900
+  d_fft = new gr::fft::fft_complex(d_fft_len, true);
+#else
+  d_fft = new gr::fft::fft_complex_fwd(d_fft_len, true);
+#endif
+}
+
+void signal_detector_cvf_impl::free_buffers() {
   delete d_fft;
   volk_free(d_tmpbuf);
   volk_free(d_tmp_pxx);
   volk_free(d_pxx);
   volk_free(d_pxx_out);
+  volk_free(d_welch_sum);
+  volk_free(d_mag);
+}
+
+// work out how many input vectors make up an interval and how far apart its
+// FFT segments are, then start a fresh interval
+void signal_detector_cvf_impl::build_duty_cycle() {
+  gr::thread::scoped_lock guard(d_mutex);
+  d_interval_vectors = std::max(1, (int)round(d_interval * d_samp_rate / d_fft_len));
+  d_segments = std::min(std::max(d_segments, 1u), d_interval_vectors);
+  d_stride = d_interval_vectors / d_segments;
+  d_vector_count = 0;
+  d_segment_count = 0;
+}
+
+void signal_detector_cvf_impl::set_detection_interval(double interval) {
+  d_interval = interval;
+  build_duty_cycle();
+  BOOST_LOG_TRIVIAL(info) << "signal_detector_cvf_impl: interval: " << d_interval << "s, " << d_segments << " of every " << d_interval_vectors << " vectors processed";
+}
+
+void signal_detector_cvf_impl::set_segments(int segments) {
+  d_segments = std::max(segments, 1);
+  build_duty_cycle();
+  BOOST_LOG_TRIVIAL(info) << "signal_detector_cvf_impl: interval: " << d_interval << "s, " << d_segments << " of every " << d_interval_vectors << " vectors processed";
 }
 
 void signal_detector_cvf_impl::set_fft_len(int fft_len) {
+  free_buffers();
   signal_detector_cvf_impl::d_fft_len = fft_len;
-  delete d_fft;
-  volk_free(d_tmpbuf);
-  volk_free(d_tmp_pxx);
-  volk_free(d_pxx);
-  volk_free(d_pxx_out);
-#if GNURADIO_VERSION < 0x030900
-  d_fft = new gr::fft::fft_complex(fft_len, true);
-#else
-  d_fft = new gr::fft::fft_complex_fwd(fft_len, true);
-#endif
-  d_tmpbuf = static_cast<float *>(volk_malloc(sizeof(float) * d_fft_len, volk_get_alignment()));
-  d_tmp_pxx = static_cast<float *>(volk_malloc(sizeof(float) * d_fft_len, volk_get_alignment()));
-  d_pxx = static_cast<float *>(volk_malloc(sizeof(float) * d_fft_len, volk_get_alignment()));
-  d_pxx_out = (float *)volk_malloc(sizeof(float) * d_fft_len, volk_get_alignment());
+  allocate_buffers();
   d_avg_filter.resize(d_fft_len);
   build_window();
   for (unsigned int i = 0; i < d_fft_len; i++) {
@@ -160,6 +178,7 @@ void signal_detector_cvf_impl::set_fft_len(int fft_len) {
   }
   set_decimation(fft_len);
   d_freq = build_freq();
+  build_duty_cycle();
 }
 
 void signal_detector_cvf_impl::set_window_type(int window) {
@@ -174,8 +193,8 @@ void signal_detector_cvf_impl::set_window_type(int window) {
   build_window();
 }
 
-// calculate periodogram and save in specified array
-void signal_detector_cvf_impl::periodogram(float *pxx, const gr_complex *signal) {
+// window and FFT one segment, adding its power to the interval's Welch sum
+void signal_detector_cvf_impl::add_segment(const gr_complex *signal) {
   if (d_window.size()) {
     // window signal
     volk_32fc_32f_multiply_32fc(
@@ -187,9 +206,23 @@ void signal_detector_cvf_impl::periodogram(float *pxx, const gr_complex *signal)
 
   d_fft->execute(); // fft
 
-  // calc fft to periodogram
-  volk_32fc_s32f_x2_power_spectral_density_32f(
-      pxx, d_fft->get_outbuf(), d_fft_len, 1.0, d_fft_len);
+  if (d_segment_count == 0) {
+    volk_32fc_magnitude_squared_32f(d_welch_sum, d_fft->get_outbuf(), d_fft_len);
+  } else {
+    volk_32fc_magnitude_squared_32f(d_mag, d_fft->get_outbuf(), d_fft_len);
+    volk_32f_x2_add_32f(d_welch_sum, d_welch_sum, d_mag, d_fft_len);
+  }
+  d_segment_count++;
+}
+
+// average the segments into a periodogram in dB and save in specified array.
+// With one segment this is what volk_32fc_s32f_x2_power_spectral_density_32f
+// gives for a normalization of 1 and a bandwidth of fft_len.
+void signal_detector_cvf_impl::welch_estimate(float *pxx) {
+  float scale = 1.0 / (d_segment_count * d_fft_len);
+  for (unsigned int i = 0; i < d_fft_len; i++) {
+    pxx[i] = 10.0 * log10f(d_welch_sum[i] * scale);
+  }
 
   // do fftshift
   d_tmpbuflen = static_cast<unsigned int>(floor(d_fft_len / 2.0));
@@ -227,13 +260,17 @@ void signal_detector_cvf_impl::build_window() {
 void signal_detector_cvf_impl::build_threshold() {
   // copy array to work with
   memcpy(d_tmp_pxx, d_pxx_out, sizeof(float) * d_fft_len);
-  // sort bins
   d_threshold = 500;
-  
-  std::sort(d_tmp_pxx, d_tmp_pxx + d_fft_len);
-  
 
-  float range = d_tmp_pxx[d_fft_len - 1] - d_tmp_pxx[0];
+  // Only the bins from the median up are searched, so partition around the
+  // median in O(n) and sort just the upper half. The lower half only
+  // contributes its minimum to the range.
+  unsigned int median = d_fft_len / 2;
+  std::nth_element(d_tmp_pxx, d_tmp_pxx + median, d_tmp_pxx + d_fft_len);
+  std::sort(d_tmp_pxx + median, d_tmp_pxx + d_fft_len);
+  float floor_rssi = (median > 0) ? *std::min_element(d_tmp_pxx, d_tmp_pxx + median) : d_tmp_pxx[0];
+
+  float range = d_tmp_pxx[d_fft_len - 1] - floor_rssi;
   // float median = d_tmp_pxx[int(d_fft_len/2)];
   // float mean = 0;
   // for (unsigned int i = d_fft_len/4; i < d_fft_len*.75; i++) {
@@ -279,6 +316,24 @@ std::vector<Detected_Signal> signal_detector_cvf_impl::find_signal_edges() {
   for (unsigned int i = 0; i < d_fft_len; i++) {
     // std::cout << "d_pxx_out[" << i << "] = " << d_pxx_out[i] << " Threshold: " << d_threshold << std::endl;
 
+    if (!signal_started) {
+      // Most bins are noise. Skip blocks with nothing above the threshold
+      // using a branch-free test the compiler can vectorize.
+      while (i + 8 <= d_fft_len) {
+        int above = 0;
+        for (unsigned int j = 0; j < 8; j++) {
+          above |= (d_pxx_out[i + j] > d_threshold);
+        }
+        if (above) {
+          break;
+        }
+        i += 8;
+      }
+      if (i >= d_fft_len) {
+        break;
+      }
+    }
+
     if (d_pxx_out[i] > d_threshold) {
       if (!signal_started) {
         signal_started = true;
@@ -396,28 +451,46 @@ int signal_detector_cvf_impl::work(int noutput_items,
                                    gr_vector_void_star &output_items) {
   const gr_complex *in = (const gr_complex *)input_items[0];
   // float* out = (float*)output_items[0];
+  int i = 0;
+
+  // Skip straight to the next vector that needs work: the next FFT segment,
+  // or the end of the interval.
+  while (i < noutput_items) {
+    unsigned int next = (d_segment_count < d_segments) ? d_segment_count * d_stride : d_interval_vectors;
+    unsigned int skip = next - d_vector_count;
+    if (skip >= (unsigned int)(noutput_items - i)) {
+      d_vector_count += noutput_items - i;
+      break;
+    }
+    i += skip;
+    d_vector_count += skip;
+
+    if (d_segment_count < d_segments) {
+      add_segment(in + i * d_fft_len);
+      i++;
+      d_vector_count++;
+      continue;
+    }
 
-    uint64_t current_time_ms = time_since_epoch_millisec();
-    if ((current_time_ms - last_conventional_channel_detection_check) >= 100.0) { //0.05) {
-
-      periodogram(d_pxx, in);
-
-      // averaging
-      for (unsigned int i = 0; i < d_fft_len; i++) {
-        d_pxx_out[i] = d_avg_filter[i].filter(d_pxx[i]);
-      }
+    welch_estimate(d_pxx);
 
-      if (d_auto_threshold) {
-        build_threshold();
-      }
+    // averaging
+    for (unsigned int j = 0; j < d_fft_len; j++) {
+      d_pxx_out[j] = d_avg_filter[j].filter(d_pxx[j]);
+    }
 
-      gr::thread::scoped_lock guard(d_mutex);
-      d_detected_signals = find_signal_edges();
-      last_conventional_channel_detection_check = current_time_ms;
+    if (d_auto_threshold) {
+      build_threshold();
     }
+
+    gr::thread::scoped_lock guard(d_mutex);
+    d_detected_signals = find_signal_edges();
+    d_vector_count = 0;
+    d_segment_count = 0;
+  }
   // BOOST_LOG_TRIVIAL(info) << "d_detected_signals.size() = " << d_detected_signals.size() << std::endl;
 
-  return 1; // one vector has been processed
+  return noutput_items; // every vector has been consumed, processed or not
 }
 
 //} /* namespace inspector */
@@ -38,16 +38,24 @@ private:
   unsigned int d_fft_len;
   unsigned int d_tmpbuflen;
   float d_threshold, d_sensitivity, d_average, d_quantization, d_min_bw, d_max_bw;
-  float *d_pxx, *d_tmp_pxx, *d_pxx_out, *d_tmpbuf;
+  float *d_pxx, *d_tmp_pxx, *d_pxx_out, *d_tmpbuf, *d_welch_sum, *d_mag;
   double d_samp_rate;
 
+  // Duty cycle: each detection interval of d_interval_vectors input vectors
+  // runs d_segments FFTs, d_stride vectors apart, and the rest are skipped.
+  double d_interval;
+  unsigned int d_segments;
+  unsigned int d_interval_vectors;
+  unsigned int d_stride;
+  unsigned int d_vector_count;
+  unsigned int d_segment_count;
+
   std::vector<gr::filter::single_pole_iir<float, float, double>> d_avg_filter;
 #if GNURADIO_VERSION < 0x030900
   gr::filter::firdes::win_type d_window_type;
 #else
   gr::fft::window::win_type d_window_type;
 #endif
-  uint64_t last_conventional_channel_detection_check;
   std::vector<float> d_window;
   std::vector<std::vector<float>> d_signal_edges;
   std::vector<std::vector<float>> d_rf_map;
@@ -59,7 +67,9 @@ private:
 #endif
   std::vector<float> d_freq;
   const char *d_filename;
-  uint64_t time_since_epoch_millisec();
+  void allocate_buffers();
+  void free_buffers();
+  void build_duty_cycle();
 
 public:
   signal_detector_cvf_impl(double samp_rate,
@@ -85,8 +95,9 @@ public:
   // signal grouping logic
   std::vector<Detected_Signal> find_signal_edges();
 
-  // PSD estimation
-  void periodogram(float *pxx, const gr_complex *signal);
+  // PSD estimation, Welch averaged over the segments of an interval
+  void add_segment(const gr_complex *signal);
+  void welch_estimate(float *pxx);
 
   std::vector<Detected_Signal> get_detected_signals();
 
@@ -96,6 +107,7 @@ public:
 
   void set_samp_rate(double d_samp_rate) {
     signal_detector_cvf_impl::d_samp_rate = d_samp_rate;
+    build_duty_cycle();
   }
 
   void set_fft_len(int fft_len);
@@ -121,6 +133,9 @@ public:
     }
   }
 
+  void set_detection_interval(double interval);
+  void set_segments(int segments);
+
   void set_quantization(float d_quantization) {
     signal_detector_cvf_impl::d_quantization = d_quantization;
   }
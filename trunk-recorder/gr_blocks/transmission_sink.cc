@@ -308,6 +308,12 @@ int transmission_sink::work(int noutput_items, gr_vector_const_void_star &input_
 
   gr::thread::scoped_lock guard(d_mutex); // hold mutex for duration of this function
   std::string loghdr = log_header(d_current_call_short_name,d_current_call_num,d_current_call_talkgroup_display,d_current_call_freq);
+
+  // Not assigned to a call, but the recorder has been left tuned to a channel.
+  // Whatever it decodes there, terminators included, is expected and dropped.
+  if (state == AVAILABLE) {
+    return noutput_items;
+  }
   
   // it is possible that we could get part of a transmission after a call has stopped. We shouldn't do any recording if this happens.... this could mean that we miss part of the recording though
   if (!d_current_call) {
@@ -326,7 +332,7 @@ int transmission_sink::work(int noutput_items, gr_vector_const_void_star &input_
   }
 
   // it is possible that we could get part of a transmission after a call has stopped. We shouldn't do any recording if this happens.... this could mean that we miss part of the recording though
-  if ((state == STOPPED) || (state == AVAILABLE)) {
+  if (state == STOPPED) {
     if (noutput_items > 1) {
 
       BOOST_LOG_TRIVIAL(error) << loghdr << "Dropping " << noutput_items << " samples - Recorder state is: " << format_state(this->state);
@@ -65,11 +65,11 @@ xlat_channelizer::xlat_channelizer(double input_rate, int samples_per_symbol, do
   // double resampled_rate = float(input_rate) / float(decimation);
 
   std::vector<gr_complex> if_coeffs;
-  if_coeffs = gr::filter::firdes::complex_band_pass_2(1, input_rate, -24000, 24000, 12000, 10);
+  if_coeffs = filter_cache::complex_band_pass_2(1, input_rate, -24000, 24000, 12000, 10);
 
   freq_xlat = make_freq_xlating_fft_filter(initial_decim, if_coeffs, 0, input_rate); // inital_lpf_taps, 0, input_rate);
 
-  std::vector<float> channel_lpf_taps = gr::filter::firdes::low_pass_2(1.0, initial_rate, d_bandwidth / 2, d_bandwidth / 4, 60);
+  std::vector<float> channel_lpf_taps = filter_cache::low_pass_2(1.0, initial_rate, d_bandwidth / 2, d_bandwidth / 4, 60);
   channel_lpf = gr::filter::fft_filter_ccf::make(decim, channel_lpf_taps);
 
   // BOOST_LOG_TRIVIAL(info) << "\t Xlating Channelizer single-stage decimator - Decim: " << decimation << " Resampled Rate: " << resampled_rate << " Lowpass Taps: " << if_coeffs.size();
@@ -98,11 +98,7 @@ xlat_channelizer::xlat_channelizer(double input_rate, int samples_per_symbol, do
 
 // As we drop the bw factor, the optfir filter has a harder time converging;
 // using the firdes method here for better results.
-#if GNURADIO_VERSION < 0x030900
-    arb_taps = gr::filter::firdes::low_pass_2(arb_size, arb_size, bw, tb, arb_atten, gr::filter::firdes::WIN_BLACKMAN_HARRIS);
-#else
-    arb_taps = gr::filter::firdes::low_pass_2(arb_size, arb_size, bw, tb, arb_atten, gr::fft::window::WIN_BLACKMAN_HARRIS);
-#endif
+    arb_taps = filter_cache::low_pass_2(arb_size, arb_size, bw, tb, arb_atten, filter_window_t::WIN_BLACKMAN_HARRIS);
     BOOST_LOG_TRIVIAL(info) << "\t Channelizer ARB - Symbol Rate: " << channel_rate << " Resampled Rate: " << resampled_rate << " ARB Rate: " << arb_rate << " ARB Taps: " << arb_taps.size() << " BW: " << bw << " TB: " << tb;
     arb_resampler = gr::filter::pfb_arb_resampler_ccf::make(arb_rate, arb_taps);
   } else if (arb_rate > 1) {
@@ -172,8 +168,7 @@ void xlat_channelizer::tune_offset(double f) {
 }
 
 void xlat_channelizer::set_max_dev(double max_dev) {
-  std::vector<float> channel_lpf_taps = gr::filter::firdes::low_pass_2(1.0, initial_rate, max_dev, d_bandwidth / 2, 60);
-  channel_lpf->set_taps(channel_lpf_taps);
+  channel_lpf->set_taps(filter_cache::low_pass_2(1.0, initial_rate, max_dev, d_bandwidth / 2, 60));
 }
 
 void xlat_channelizer::set_squelch_db(double squelch_db) {
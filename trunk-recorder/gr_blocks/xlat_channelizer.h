@@ -4,6 +4,7 @@
 #include <boost/log/trivial.hpp>
 #include <iomanip>
 
+#include "./filter_cache.h"
 #include "./rms_agc.h"
 #include "./freq_xlating_fft_filter.h"
 #include "./pwr_squelch_cc.h"
@@ -0,0 +1,91 @@
+#include "json_writer.h"
+#include <boost/property_tree/json_parser.hpp>
+#include <sstream>
+
+void Json_Writer::begin_value(const char *name) {
+  if (containers.empty()) {
+    return;
+  }
+
+  Container &parent = containers.back();
+  if (!parent.empty) {
+    buffer += ',';
+  }
+  parent.empty = false;
+
+  if (!name) {
+    name = pending_key;
+  }
+  pending_key = NULL;
+
+  if (buffer[parent.start] == '{') {
+    buffer += '"';
+    append_escaped(name ? name : "", name ? strlen(name) : 0);
+    buffer += "\":";
+  }
+}
+
+void Json_Writer::begin_container(char open, const char *name) {
+  begin_value(name);
+  containers.push_back({buffer.size(), true});
+  buffer += open;
+}
+
+void Json_Writer::end_container(char close) {
+  Container container = containers.back();
+  containers.pop_back();
+
+  // write_json has no way to tell an empty child from an empty value
+  if (container.empty && !containers.empty()) {
+    buffer.resize(container.start);
+    buffer += "\"\"";
+  } else {
+    buffer += close;
+  }
+}
+
+void Json_Writer::put(const char *name, const char *value, size_t len) {
+  begin_value(name);
+  buffer += '"';
+  append_escaped(value, len);
+  buffer += '"';
+}
+
+// Same escapes as write_json: bytes above 0x7F are passed through and '/' is
+// escaped.
+void Json_Writer::append_escaped(const char *value, size_t len) {
+  static const char *hexdigits = "0123456789ABCDEF";
+
+  for (size_t i = 0; i < len; i++) {
+    unsigned char c = value[i];
+
+    if (c == 0x20 || c == 0x21 || (c >= 0x23 && c <= 0x2E) || (c >= 0x30 && c <= 0x5B) || (c >= 0x5D)) {
+      buffer += (char)c;
+      continue;
+    }
+
+    buffer += '\\';
+    switch (c) {
+    case '\b': buffer += 'b'; break;
+    case '\f': buffer += 'f'; break;
+    case '\n': buffer += 'n'; break;
+    case '\r': buffer += 'r'; break;
+    case '\t': buffer += 't'; break;
+    case '/':  buffer += '/'; break;
+    case '"':  buffer += '"'; break;
+    case '\\': buffer += '\\'; break;
+    default:
+      buffer += "u00";
+      buffer += hexdigits[c >> 4];
+      buffer += hexdigits[c & 0xF];
+      break;
+    }
+  }
+}
+
+boost::property_tree::ptree Json_Writer::to_ptree() const {
+  boost::property_tree::ptree node;
+  std::stringstream json(buffer);
+  boost::property_tree::read_json(json, node);
+  return node;
+}
@@ -0,0 +1,89 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <boost/property_tree/ptree.hpp>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/*
+ * Streams JSON straight into a buffer that is kept between messages, so a
+ * snapshot of every Call or Recorder costs no allocations once the buffer
+ * has grown to size.
+ *
+ * The output reads the same as boost::property_tree::write_json, which the
+ * status messages were written with before: every value is a quoted string,
+ * numbers use the same precision, and an empty object or array below the top
+ * level is written as "". It is not pretty printed.
+ */
+class Json_Writer {
+public:
+  Json_Writer() { buffer.reserve(4096); }
+
+  void clear() {
+    buffer.clear();
+    containers.clear();
+    pending_key = NULL;
+  }
+
+  const std::string &str() const { return buffer; }
+
+  // Sets the key for the next value, object or array written into an object
+  void key(const char *name) { pending_key = name; }
+  void key(const std::string &name) {
+    pending_key_str = name;
+    pending_key = pending_key_str.c_str();
+  }
+
+  void begin_object(const char *name = NULL) { begin_container('{', name); }
+  void end_object() { end_container('}'); }
+  void begin_array(const char *name = NULL) { begin_container('[', name); }
+  void end_array() { end_container(']'); }
+
+  void put(const char *name, const std::string &value) { put(name, value.c_str(), value.size()); }
+  void put(const char *name, const char *value) { put(name, value, strlen(value)); }
+  void put(const char *name, bool value) { put(name, value ? "true" : "false"); }
+
+  template <typename T, typename = typename std::enable_if<std::is_arithmetic<T>::value || std::is_enum<T>::value>::type>
+  void put(const char *name, T value) {
+    char number[32];
+    int len;
+    if (std::is_floating_point<T>::value) {
+      len = snprintf(number, sizeof(number), "%.*g", std::is_same<T, float>::value ? 9 : 17, (double)value);
+    } else if (std::is_signed<T>::value || std::is_enum<T>::value) {
+      len = snprintf(number, sizeof(number), "%lld", (long long)value);
+    } else {
+      len = snprintf(number, sizeof(number), "%llu", (unsigned long long)value);
+    }
+    put(name, number, len);
+  }
+
+  // Value in an array
+  template <typename T>
+  void push(T value) { put(NULL, value); }
+
+  // For callers that still want a property_tree. It is parsed back out of
+  // the JSON, so it is not meant for hot paths.
+  boost::property_tree::ptree to_ptree() const;
+
+private:
+  struct Container {
+    size_t start;
+    bool empty;
+  };
+
+  std::string buffer;
+  std::vector<Container> containers;
+  std::string pending_key_str;
+  const char *pending_key = NULL;
+
+  void put(const char *name, const char *value, size_t len);
+  void begin_value(const char *name);
+  void begin_container(char open, const char *name);
+  void end_container(char close);
+  void append_escaped(const char *value, size_t len);
+};
+
+#endif
@@ -37,6 +37,11 @@
 
 #include "./global_structs.h"
 #include "config.h"
+#include "metrics.h"
+#include "recorder_pool.h"
+#include "state_snapshot.h"
+#include "flowgraph_stats.h"
+#include "call_concluder/call_journal.h"
 #include "recorder_globals.h"
 #include "source.h"
 
@@ -121,12 +126,23 @@ int main(int argc, char **argv) {
     exit(1);
   }
 
+  // Before setup_systems, so it tunes the restored control channels
+  State_Snapshot::init(config, systems);
+
   start_plugins(sources, systems);
 
   if (setup_systems(config, tb, sources, systems, calls)) {
 
+    Metrics::init(config, systems);
+    Call_Journal::init(config);
+    Recorder_Pool::init(config, systems);
+    Flowgraph_Stats::init(config, tb);
     tb->start();
 
+    for (vector<Source *>::iterator it = sources.begin(); it != sources.end(); ++it) {
+      (*it)->apply_realtime_priority(tb);
+    }
+
     exit_code = monitor_messages(config, tb, sources, systems, calls);
 
     // ------------------------------------------------------------------
@@ -138,6 +154,7 @@ int main(int argc, char **argv) {
 
     BOOST_LOG_TRIVIAL(info) << "stopping plugins" << std::endl;
     stop_plugins();
+    Call_Journal::close();
   } else {
     BOOST_LOG_TRIVIAL(error) << "Unable to setup a System to record, exiting..." << std::endl;
   }
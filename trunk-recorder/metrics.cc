@@ -0,0 +1,265 @@
+#include "metrics.h"
+#include "recorders/recorder.h"
+#include "source.h"
+#include "systems/system.h"
+#include <boost/asio.hpp>
+#include <boost/log/trivial.hpp>
+#include <sstream>
+#include <thread>
+
+const double Metrics_Histogram::bounds[Metrics_Histogram::BUCKETS] = {0.5, 1, 2.5, 5, 10, 30, 60, 120, 300, 600};
+
+std::vector<System_Metrics *> Metrics::systems = {};
+std::atomic<int> Metrics::recorders[SMARTNET + 1][IGNORE + 1] = {};
+std::atomic<int> Metrics::concluder_workers(0);
+std::atomic<int> Metrics::concluder_retries(0);
+std::atomic<uint64_t> Metrics::overrun_samples(0);
+Metrics_Histogram Metrics::upload_seconds;
+System_Metrics Metrics::unknown_system;
+
+static const char *recorder_type_names[SMARTNET + 1] = {"debug", "sigmf", "sigmfc", "analog", "analogc", "p25", "p25c", "dmr", "smartnet"};
+static const char *state_names[IGNORE + 1] = {"monitoring", "recording", "inactive", "active", "idle", NULL, "stopped", "available", "ignore"};
+
+void Metrics_Histogram::observe(double seconds) {
+  int i = 0;
+  while ((i < BUCKETS) && (seconds > bounds[i])) {
+    i++;
+  }
+  buckets[i].fetch_add(1, std::memory_order_relaxed);
+  sum_usec.fetch_add((uint64_t)(seconds * 1000000), std::memory_order_relaxed);
+  count.fetch_add(1, std::memory_order_relaxed);
+}
+
+// The System slots are allocated once, before the monitor loop starts, so
+// the vector itself never changes while it is being read.
+void Metrics::init(Config &config, std::vector<System *> &systems) {
+  for (std::vector<System *>::iterator it = systems.begin(); it != systems.end(); ++it) {
+    System *sys = *it;
+    size_t sys_num = sys->get_sys_num();
+
+    if (Metrics::systems.size() <= sys_num) {
+      Metrics::systems.resize(sys_num + 1, NULL);
+    }
+    System_Metrics *metrics = new System_Metrics();
+    metrics->short_name = sys->get_short_name();
+    Metrics::systems[sys_num] = metrics;
+  }
+
+  if (config.metrics_port > 0) {
+    BOOST_LOG_TRIVIAL(info) << "Serving metrics on http://" << config.metrics_address << ":" << config.metrics_port << "/metrics";
+    std::thread(serve, config.metrics_address, config.metrics_port).detach();
+  }
+}
+
+System_Metrics *Metrics::for_system(System *sys) {
+  size_t sys_num = sys->get_sys_num();
+
+  if ((sys_num < systems.size()) && systems[sys_num]) {
+    return systems[sys_num];
+  }
+  return &unknown_system;
+}
+
+void Metrics::update_recorders(std::vector<Source *> &sources) {
+  int counts[SMARTNET + 1][IGNORE + 1] = {};
+
+  for (std::vector<Source *>::iterator src_it = sources.begin(); src_it != sources.end(); ++src_it) {
+    std::vector<Recorder *> source_recorders = (*src_it)->get_recorders();
+
+    for (std::vector<Recorder *>::iterator rec_it = source_recorders.begin(); rec_it != source_recorders.end(); ++rec_it) {
+      Recorder *recorder = *rec_it;
+      int type = recorder->get_type();
+      int state = recorder->get_state();
+
+      if ((type >= 0) && (type <= SMARTNET) && (state >= 0) && (state <= IGNORE)) {
+        counts[type][state]++;
+      }
+    }
+  }
+
+  for (int type = 0; type <= SMARTNET; type++) {
+    for (int state = 0; state <= IGNORE; state++) {
+      recorders[type][state].store(counts[type][state], std::memory_order_relaxed);
+    }
+  }
+}
+
+static std::string escape_label(const std::string &value) {
+  std::string escaped;
+  for (std::string::const_iterator it = value.begin(); it != value.end(); ++it) {
+    if (*it == '\\') {
+      escaped += "\\\\";
+    } else if (*it == '"') {
+      escaped += "\\\"";
+    } else if (*it == '\n') {
+      escaped += "\\n";
+    } else {
+      escaped += *it;
+    }
+  }
+  return escaped;
+}
+
+static void render_system_counter(std::stringstream &out, const char *name, const char *help, std::atomic<uint64_t> System_Metrics::*counter) {
+  out << "# HELP " << name << " " << help << "\n";
+  out << "# TYPE " << name << " counter\n";
+  for (std::vector<System_Metrics *>::iterator it = Metrics::systems.begin(); it != Metrics::systems.end(); ++it) {
+    System_Metrics *metrics = *it;
+    if (metrics) {
+      out << name << "{system=\"" << escape_label(metrics->short_name) << "\"} " << (metrics->*counter).load(std::memory_order_relaxed) << "\n";
+    }
+  }
+}
+
+// Text exposition format 0.0.4, which both Prometheus and OpenMetrics
+// scrapers accept.
+std::string Metrics::render() {
+  std::stringstream out;
+
+  render_system_counter(out, "trunk_recorder_control_messages_total", "Control channel messages decoded.", &System_Metrics::control_messages);
+  render_system_counter(out, "trunk_recorder_grants_total", "Grant and update messages handled.", &System_Metrics::grants);
+  render_system_counter(out, "trunk_recorder_grants_rejected_total", "Grants turned away before a Call was made.", &System_Metrics::grants_rejected);
+  render_system_counter(out, "trunk_recorder_calls_recorded_total", "Calls a Recorder was started for.", &System_Metrics::calls_recorded);
+  render_system_counter(out, "trunk_recorder_preemptions_total", "Recordings stopped to free a Recorder for a higher priority Call.", &System_Metrics::preemptions);
+
+  out << "# HELP trunk_recorder_decode_rate Control channel messages decoded per second, as of the last check.\n";
+  out << "# TYPE trunk_recorder_decode_rate gauge\n";
+  for (std::vector<System_Metrics *>::iterator it = systems.begin(); it != systems.end(); ++it) {
+    System_Metrics *metrics = *it;
+    if (metrics) {
+      out << "trunk_recorder_decode_rate{system=\"" << escape_label(metrics->short_name) << "\"} " << metrics->decode_rate.load(std::memory_order_relaxed) << "\n";
+    }
+  }
+
+  out << "# HELP trunk_recorder_recorders Recorders by type and state.\n";
+  out << "# TYPE trunk_recorder_recorders gauge\n";
+  for (int type = 0; type <= SMARTNET; type++) {
+    int total = 0;
+    int counts[IGNORE + 1];
+    for (int state = 0; state <= IGNORE; state++) {
+      counts[state] = recorders[type][state].load(std::memory_order_relaxed);
+      total += counts[state];
+    }
+    if (total == 0) {
+      continue;
+    }
+    for (int state = 0; state <= IGNORE; state++) {
+      if (state_names[state]) {
+        out << "trunk_recorder_recorders{type=\"" << recorder_type_names[type] << "\",state=\"" << state_names[state] << "\"} " << counts[state] << "\n";
+      }
+    }
+  }
+
+  out << "# HELP trunk_recorder_concluder_workers Calls being converted and uploaded.\n";
+  out << "# TYPE trunk_recorder_concluder_workers gauge\n";
+  out << "trunk_recorder_concluder_workers " << concluder_workers.load(std::memory_order_relaxed) << "\n";
+  out << "# HELP trunk_recorder_concluder_retries Calls waiting to retry an upload.\n";
+  out << "# TYPE trunk_recorder_concluder_retries gauge\n";
+  out << "trunk_recorder_concluder_retries " << concluder_retries.load(std::memory_order_relaxed) << "\n";
+
+  out << "# HELP trunk_recorder_upload_seconds Time taken to convert a Call and run the upload script and plugins.\n";
+  out << "# TYPE trunk_recorder_upload_seconds histogram\n";
+  uint64_t cumulative = 0;
+  for (int i = 0; i < Metrics_Histogram::BUCKETS; i++) {
+    cumulative += upload_seconds.buckets[i].load(std::memory_order_relaxed);
+    out << "trunk_recorder_upload_seconds_bucket{le=\"" << Metrics_Histogram::bounds[i] << "\"} " << cumulative << "\n";
+  }
+  cumulative += upload_seconds.buckets[Metrics_Histogram::BUCKETS].load(std::memory_order_relaxed);
+  out << "trunk_recorder_upload_seconds_bucket{le=\"+Inf\"} " << cumulative << "\n";
+  out << "trunk_recorder_upload_seconds_sum " << upload_seconds.sum_usec.load(std::memory_order_relaxed) / 1000000.0 << "\n";
+  out << "trunk_recorder_upload_seconds_count " << cumulative << "\n";
+
+  out << "# HELP trunk_recorder_overrun_samples_total IQ samples lost because the flow graph fell behind the samples coming in.\n";
+  out << "# TYPE trunk_recorder_overrun_samples_total counter\n";
+  out << "trunk_recorder_overrun_samples_total " << overrun_samples.load(std::memory_order_relaxed) << "\n";
+
+  return out.str();
+}
+
+// Runs the read or write queued on the socket. A client that hasn't finished
+// its request, or read the response, within 5 seconds has its connection
+// closed, so it can't hold up the next scrape. The completion handler
+// cancels the deadline.
+static void run_with_deadline(boost::asio::io_service &service, boost::asio::deadline_timer &deadline, boost::asio::ip::tcp::socket &socket) {
+  deadline.expires_from_now(boost::posix_time::seconds(5));
+  deadline.async_wait([&socket](const boost::system::error_code &e) {
+    if (!e) {
+      boost::system::error_code ignored;
+      socket.close(ignored);
+    }
+  });
+  service.reset();
+  service.run();
+}
+
+// Minimal HTTP/1.0 server: one request per connection, handled in turn on
+// its own thread. Rendering only loads the atomics above.
+void Metrics::serve(std::string address, int port) {
+  typedef boost::asio::io_service io_service;
+  io_service service;
+  boost::asio::ip::tcp::acceptor acceptor(service);
+
+  try {
+    boost::asio::ip::tcp::endpoint endpoint(boost::asio::ip::address::from_string(address), port);
+    acceptor.open(endpoint.protocol());
+    acceptor.set_option(boost::asio::ip::tcp::acceptor::reuse_address(true));
+    acceptor.bind(endpoint);
+    acceptor.listen();
+  } catch (std::exception &e) {
+    BOOST_LOG_TRIVIAL(error) << "Unable to serve metrics on " << address << ":" << port << " - " << e.what();
+    return;
+  }
+
+  boost::asio::deadline_timer deadline(service);
+
+  while (1) {
+    boost::asio::ip::tcp::socket socket(service);
+    boost::system::error_code ec;
+
+    acceptor.accept(socket, ec);
+    if (ec) {
+      continue;
+    }
+
+    boost::asio::streambuf request(8192);
+    boost::asio::async_read_until(socket, request, "\r\n\r\n", [&](const boost::system::error_code &e, std::size_t) {
+      ec = e;
+      deadline.cancel();
+    });
+    run_with_deadline(service, deadline, socket);
+    if (ec) {
+      continue;
+    }
+
+    std::istream request_stream(&request);
+    std::string method, path;
+    request_stream >> method >> path;
+
+    std::string status, content_type, body;
+    if ((method == "GET") && ((path == "/metrics") || (path.compare(0, 9, "/metrics?") == 0))) {
+      status = "200 OK";
+      content_type = "text/plain; version=0.0.4; charset=utf-8";
+      body = render();
+    } else {
+      status = "404 Not Found";
+      content_type = "text/plain; charset=utf-8";
+      body = "Not Found\n";
+    }
+
+    std::stringstream response;
+    response << "HTTP/1.0 " << status << "\r\n"
+             << "Content-Type: " << content_type << "\r\n"
+             << "Content-Length: " << body.size() << "\r\n"
+             << "Connection: close\r\n\r\n";
+    std::vector<boost::asio::const_buffer> send_buffer;
+    std::string header = response.str();
+    send_buffer.push_back(boost::asio::buffer(header));
+    send_buffer.push_back(boost::asio::buffer(body));
+    boost::asio::async_write(socket, send_buffer, [&](const boost::system::error_code &e, std::size_t) {
+      ec = e;
+      deadline.cancel();
+    });
+    run_with_deadline(service, deadline, socket);
+    socket.shutdown(boost::asio::ip::tcp::socket::shutdown_both, ec);
+  }
+}
@@ -0,0 +1,60 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "global_structs.h"
+#include "state.h"
+
+class Source;
+class System;
+
+// Counters for one System. They are only ever incremented in place, so the
+// threads that handle messages never wait on a scrape.
+struct System_Metrics {
+  std::string short_name;
+  std::atomic<uint64_t> control_messages{0};
+  std::atomic<uint64_t> grants{0};
+  std::atomic<uint64_t> grants_rejected{0};
+  std::atomic<uint64_t> calls_recorded{0};
+  std::atomic<uint64_t> preemptions{0};
+  std::atomic<int> decode_rate{0};
+};
+
+// Fixed bucket histogram. The sum is kept in microseconds so it can be an
+// integer atomic.
+struct Metrics_Histogram {
+  static const int BUCKETS = 10;
+  static const double bounds[BUCKETS];
+
+  std::atomic<uint64_t> buckets[BUCKETS + 1]{};
+  std::atomic<uint64_t> count{0};
+  std::atomic<uint64_t> sum_usec{0};
+
+  void observe(double seconds);
+};
+
+class Metrics {
+
+public:
+  static std::vector<System_Metrics *> systems;
+  static std::atomic<int> recorders[SMARTNET + 1][IGNORE + 1];
+  static std::atomic<int> concluder_workers;
+  static std::atomic<int> concluder_retries;
+  static std::atomic<uint64_t> overrun_samples;
+  static Metrics_Histogram upload_seconds;
+
+  static void init(Config &config, std::vector<System *> &systems);
+  static System_Metrics *for_system(System *sys);
+  static void update_recorders(std::vector<Source *> &sources);
+  static std::string render();
+
+private:
+  static System_Metrics unknown_system;
+  static void serve(std::string address, int port);
+};
+
+#endif
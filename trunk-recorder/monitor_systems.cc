@@ -1,5 +1,14 @@
 #include "monitor_systems.h"
+#include "flowgraph_stats.h"
+#include "metrics.h"
+#include "recorder_pool.h"
 #include "recorders/p25_recorder.h"
+#include "setup_systems.h"
+#include "state_snapshot.h"
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <thread>
 using namespace std;
 
 volatile sig_atomic_t exit_flag = 0;
@@ -9,11 +18,119 @@ void exit_interupt(int sig) { // can be called asynchronously
   exit_flag = 1;              // set flag
 }
 
+volatile sig_atomic_t reload_flag = 0;
+std::atomic<bool> reload_running(false);
+
+void reload_interupt(int sig) {
+  reload_flag = 1;
+}
+
+// Runs on its own thread, so parsing big files doesn't hold up the control
+// channels. Each table is swapped in whole once it has been read.
+void reload_tables(std::vector<System *> systems) {
+  for (std::vector<System *>::iterator it = systems.begin(); it != systems.end(); ++it) {
+    System_impl *sys = (System_impl *)*it;
+    sys->reload_talkgroups();
+    sys->reload_unit_tags();
+  }
+  reload_running = false;
+}
+
 uint64_t time_since_epoch_millisec() {
   using namespace std::chrono;
   return duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
 }
 
+// The priority of a talkgroup, raised to that of any talkgroup it is patched with
+int get_talkgroup_priority(Talkgroup *talkgroup, System *sys, bool log_patches) {
+  int priority = talkgroup->get_priority();
+  BOOST_FOREACH (auto &TGID, sys->get_talkgroup_patch(talkgroup->number)) {
+    if (sys->find_talkgroup(TGID) != NULL) {
+      if (sys->find_talkgroup(TGID)->get_priority() < priority) {
+        priority = sys->find_talkgroup(TGID)->get_priority();
+        if (log_patches) {
+          BOOST_LOG_TRIVIAL(info) << "Temporarily increased priority of talkgroup " << talkgroup->number << " to " << sys->find_talkgroup(TGID)->get_priority() << " due to active patch with talkgroup " << TGID;
+        }
+      }
+    }
+  }
+  return priority;
+}
+
+// When the Source that covers the call's freq is one Recorder short of what
+// the talkgroup's priority needs, stop the lowest priority recording on it, if
+// that is lower than the call's, so its Recorder can be used instead. Among
+// equal priorities the oldest call is stopped. The stopped call is concluded
+// while still RECORDING so its audio is kept.
+bool preempt_recorder(Call *call, System *sys, std::vector<Source *> &sources, std::vector<Call *> &calls) {
+  Talkgroup *talkgroup = sys->find_talkgroup(call->get_talkgroup());
+  if (!talkgroup || (talkgroup->get_priority() < 1)) {
+    return false;
+  }
+
+  // start_recorder() only tries the first Source that covers the freq
+  Source *source = NULL;
+  for (vector<Source *>::iterator it = sources.begin(); it != sources.end(); it++) {
+    if (((*it)->get_min_hz() <= call->get_freq()) && ((*it)->get_max_hz() >= call->get_freq())) {
+      source = *it;
+      break;
+    }
+  }
+  if (source == NULL) {
+    return false;
+  }
+
+  int priority = get_talkgroup_priority(talkgroup, sys, false);
+  Recorder_Type type = (talkgroup->mode.compare("A") == 0) ? ANALOG : P25;
+  int available = (type == ANALOG) ? source->get_num_available_analog_recorders() : source->get_num_available_digital_recorders();
+  if (available != priority - 1) {
+    return false;
+  }
+
+  Call *victim = NULL;
+  int victim_priority = priority;
+
+  for (vector<Call *>::iterator it = calls.begin(); it != calls.end(); it++) {
+    Call *active = *it;
+
+    if ((active->get_state() != RECORDING) || active->is_conventional()) {
+      continue;
+    }
+
+    Recorder *recorder = active->get_recorder();
+    if ((recorder == NULL) || (recorder->get_type() != type) || (recorder->get_source() != source)) {
+      continue;
+    }
+
+    int active_priority = INT_MAX;
+    Talkgroup *active_talkgroup = active->get_system()->find_talkgroup(active->get_talkgroup());
+    if (active_talkgroup) {
+      active_priority = get_talkgroup_priority(active_talkgroup, active->get_system(), false);
+    }
+
+    if ((active_priority > victim_priority) || ((victim != NULL) && (active_priority == victim_priority) && (active->elapsed() > victim->elapsed()))) {
+      victim = active;
+      victim_priority = active_priority;
+    }
+  }
+
+  if (victim == NULL) {
+    return false;
+  }
+
+  Recorder *recorder = victim->get_recorder();
+  std::string loghdr = log_header( call->get_short_name(), call->get_call_num(), call->get_talkgroup_display(), call->get_freq());
+  BOOST_LOG_TRIVIAL(info) << loghdr << "\u001b[33mPreempting Call\u001b[0m \u001b[34m" << victim->get_call_num() << "C\u001b[0m TG: " << victim->get_talkgroup_display() << " Priority: " << (victim_priority == INT_MAX ? "none" : std::to_string(victim_priority)) << " for Priority: " << priority;
+
+  victim->conclude_call();
+  victim->set_state(MONITORING);
+  victim->set_monitoring_state(PREEMPTED);
+  plugman_setup_recorder(recorder);
+  ((System_impl *)sys)->preemption_count++;
+  Metrics::for_system(sys)->preemptions++;
+  return true;
+}
+
 bool start_recorder(Call *call, TrunkMessage message, Config &config, System *sys, std::vector<Source *> &sources) {
   Talkgroup *talkgroup = sys->find_talkgroup(call->get_talkgroup());
 
@@ -72,6 +189,8 @@ bool start_recorder(Call *call, TrunkMessage message, Config &config, System *sy
     }
   }
 
+  std::chrono::steady_clock::time_point alloc_start = std::chrono::steady_clock::now();
+
   for (vector<Source *>::iterator it = sources.begin(); it != sources.end(); it++) {
     Source *source = *it;
 
@@ -80,15 +199,7 @@ bool start_recorder(Call *call, TrunkMessage message, Config &config, System *sy
       source_found = true;
 
       if (talkgroup) {
-        int priority = talkgroup->get_priority();
-        BOOST_FOREACH (auto &TGID, sys->get_talkgroup_patch(call->get_talkgroup())) {
-          if (sys->find_talkgroup(TGID) != NULL) {
-            if (sys->find_talkgroup(TGID)->get_priority() < priority) {
-              priority = sys->find_talkgroup(TGID)->get_priority();
-              BOOST_LOG_TRIVIAL(info) << "Temporarily increased priority of talkgroup " << call->get_talkgroup() << " to " << sys->find_talkgroup(TGID)->get_priority() << " due to active patch with talkgroup " << TGID;
-            }
-          }
-        }
+        int priority = get_talkgroup_priority(talkgroup, sys, true);
         if (talkgroup->mode.compare("A") == 0) {
           recorder = source->get_analog_recorder(talkgroup, priority, call);
           call->set_is_analog(true);
@@ -110,17 +221,26 @@ bool start_recorder(Call *call, TrunkMessage message, Config &config, System *sy
         }
       }
 
+      ((System_impl *)sys)->add_recorder_alloc_time(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - alloc_start).count());
+
       if (recorder) {
         if (message.meta.length()) {
           BOOST_LOG_TRIVIAL(trace) << message.meta;
         }
 
+        bool pretuned = (recorder->get_parked_freq() == call->get_freq());
+
         if (recorder->start(call)) {
           call->set_recorder(recorder);
           call->set_state(RECORDING);
           plugman_setup_recorder(recorder);
+          Metrics::for_system(sys)->calls_recorded++;
           recorder_found = true;
+          if (pretuned) {
+            ((System_impl *)sys)->pretune_hit_count++;
+          }
         } else {
+          source->release_recorder(recorder);
           call->set_state(MONITORING);
           // call->set_monitoring_state(NO_SOURCE);
           recorder_found = false;
@@ -210,7 +330,7 @@ void print_status(std::vector<Source *> &sources, std::vector<System *> &systems
     if ((sys->get_system_type() != "conventional") && (sys->get_system_type() != "conventionalP25") && (sys->get_system_type() != "conventionalDMR") && (sys->get_system_type() != "conventionalSIGMF")) {
       BOOST_LOG_TRIVIAL(info) << "[" << sys->get_short_name() << "]\t" << format_freq(sys->get_current_control_channel()) << "\t" << sys->get_decode_rate() << " msg/sec";
       
-      if ((sys->get_source()->get_autotune_source()) && (sys->get_system_type() == "p25")) {
+      if (sys->get_source() && (sys->get_source()->get_autotune_source()) && (sys->get_system_type() == "p25")) {
         // If control channel source has autotune enabled, perform autotune adjustments and log to console
         autotune_control_channel(sys);
       }
@@ -278,6 +398,48 @@ void manage_conventional_call(Call *call, Config &config) {
   }
 }
 
+// Talkgroups stay candidates for pre-tuning this long after their last grant or affiliation
+const time_t pretune_window = 120;
+
+void pretune_recorders(Config &config, std::vector<Source *> &sources, std::vector<System *> &systems) {
+  std::vector<Pretune_Freq> candidates;
+  for (vector<System *>::iterator it = systems.begin(); it != systems.end(); it++) {
+    System *sys = *it;
+    if ((sys->get_system_type() == "p25") || (sys->get_system_type() == "smartnet")) {
+      std::vector<Pretune_Freq> freqs = ((System_impl *)sys)->get_pretune_freqs(pretune_window);
+      candidates.insert(candidates.end(), freqs.begin(), freqs.end());
+    }
+  }
+
+  std::sort(candidates.begin(), candidates.end(), [](const Pretune_Freq &a, const Pretune_Freq &b) {
+    if (a.priority != b.priority) {
+      return a.priority < b.priority;
+    }
+    return a.last_active > b.last_active;
+  });
+
+  for (vector<Source *>::iterator it = sources.begin(); it != sources.end(); it++) {
+    Source *source = *it;
+    std::vector<Pretune_Freq> freqs;
+    for (vector<Pretune_Freq>::iterator f = candidates.begin(); (f != candidates.end()) && ((int)freqs.size() < config.pretune_recorders); f++) {
+      if ((source->get_min_hz() > f->freq) || (source->get_max_hz() < f->freq)) {
+        continue;
+      }
+      bool duplicate = false;
+      for (vector<Pretune_Freq>::iterator d = freqs.begin(); d != freqs.end(); d++) {
+        if (d->freq == f->freq) {
+          duplicate = true;
+          break;
+        }
+      }
+      if (!duplicate) {
+        freqs.push_back(*f);
+      }
+    }
+    source->pretune_digital_recorders(freqs);
+  }
+}
+
 void manage_calls(Config &config, std::vector<Call *> &calls) {
   bool ended_call = false;
   for (vector<Call *>::iterator it = calls.begin(); it != calls.end();) {
@@ -358,6 +520,7 @@ void unit_acknowledge_response(System *sys, long source_id) {
 }
 
 void unit_group_affiliation(System *sys, long source_id, long talkgroup_num) {
+  ((System_impl *)sys)->note_talkgroup_affiliation(talkgroup_num);
   plugman_unit_group_affiliation(sys, source_id, talkgroup_num);
 }
 
@@ -376,6 +539,76 @@ void unit_location(System *sys, long source_id, long talkgroup_num) {
 
 
 
+// Talkgroups stay in the rejected talkgroup cache this long after their last grant or update
+const time_t rejected_talkgroup_timeout = 3600;
+
+// Checks a grant for a talkgroup that has no Call yet against the same rules
+// start_recorder() uses to decide not to record, so it can be turned away
+// before a Call is built for it. Talkgroups that are seen encrypted are
+// remembered, so UPDATEs for them, which don't carry the encryption flag, are
+// turned away too until a clear grant comes in. The rejection is only logged
+// once per call.
+bool reject_grant(TrunkMessage &message, System *sys, bool grant_message, Config &config) {
+  System_impl *sys_impl = (System_impl *)sys;
+  Talkgroup *talkgroup = sys->find_talkgroup(message.talkgroup);
+  std::string reason;
+  bool encrypted = false;
+  bool hide = false;
+
+  if (!talkgroup && !sys->get_record_unknown()) {
+    BOOST_FOREACH (auto &TGID, sys->get_talkgroup_patch(message.talkgroup)) {
+      if (sys->find_talkgroup(TGID) != NULL) {
+        // start_recorder() records unknown talkgroups that are patched with a known one
+        return false;
+      }
+    }
+    reason = "\u001b[33mNot Recording: TG not in Talkgroup File\u001b[0m ";
+    hide = sys->get_hideUnknown();
+  } else if (talkgroup && (talkgroup->get_priority() == -1)) {
+    reason = "Not recording talkgroup. Priority is -1.";
+  } else if (!sys->get_monitorEncrypted()) {
+    std::map<long, Rejected_Talkgroup>::iterator cached = sys_impl->rejected_talkgroups.find(message.talkgroup);
+    bool mode_encrypted = (talkgroup && (talkgroup->mode.compare("E") == 0 || talkgroup->mode.compare("TE") == 0 || talkgroup->mode.compare("DE") == 0));
+
+    if (message.encrypted || mode_encrypted) {
+      encrypted = true;
+    } else if ((cached != sys_impl->rejected_talkgroups.end()) && cached->second.encrypted) {
+      if (grant_message) {
+        // a grant that says it is clear overrides what was seen before
+        sys_impl->rejected_talkgroups.erase(cached);
+        return false;
+      }
+      encrypted = true;
+    } else {
+      return false;
+    }
+    reason = "\u001b[31mNot Recording: ENCRYPTED\u001b[0m";
+    hide = sys->get_hideEncrypted();
+  } else {
+    return false;
+  }
+
+  time_t now = time(NULL);
+  std::map<long, Rejected_Talkgroup>::iterator it = sys_impl->rejected_talkgroups.find(message.talkgroup);
+  bool new_call = (it == sys_impl->rejected_talkgroups.end()) || (it->second.freq != message.freq) || ((now - it->second.last_seen) > config.call_timeout);
+
+  Rejected_Talkgroup &rejected = sys_impl->rejected_talkgroups[message.talkgroup];
+  rejected.freq = message.freq;
+  rejected.last_seen = now;
+  rejected.encrypted = encrypted;
+  sys_impl->rejected_grant_count++;
+  Metrics::for_system(sys)->grants_rejected++;
+
+  if (new_call && !hide) {
+    std::string tag = sys->find_unit_tag(message.source);
+    if (tag != "") {
+      tag = " (\033[0;34m" + tag + "\033[0m)";
+    }
+    BOOST_LOG_TRIVIAL(info) << "[" << sys->get_short_name() << "]\tTG: " << message.talkgroup << "\tFreq: " << format_freq(message.freq) << "\t" << reason << (encrypted ? " - src: " + std::to_string(message.source) + tag : "");
+  }
+  return true;
+}
+
 void handle_call_grant(TrunkMessage message, System *sys, bool grant_message, Config &config, std::vector<Source *> &sources, std::vector<Call *> &calls) {
   bool call_found = false;
   bool duplicate_grant = false;
@@ -398,11 +631,17 @@ void handle_call_grant(TrunkMessage message, System *sys, bool grant_message, Co
   unsigned long call_rfss_site = 0;
   unsigned long sys_rfss_site = 0;
 
+  Metrics::for_system(sys)->grants++;
+
   Talkgroup *message_talkgroup = sys->find_talkgroup(message.talkgroup);
   if (message_talkgroup) {
     message_preferredNAC = message_talkgroup->get_preferredNAC();
   }
 
+  if (config.pretune_recorders > 0) {
+    ((System_impl *)sys)->note_talkgroup_grant(message.talkgroup, message.freq);
+  }
+
   for (vector<Call *>::iterator it = calls.begin(); it != calls.end();) {
     Call *call = *it;
 
@@ -487,8 +726,12 @@ void handle_call_grant(TrunkMessage message, System *sys, bool grant_message, Co
     it++;
   }
 
+  if (!call_found && reject_grant(message, sys, grant_message, config)) {
+    return;
+  }
+
   if (!call_found) {
-    Call *call = Call::make(message, sys, config);
+    Call *call = Call::make(message, sys, &config);
 
     Talkgroup *talkgroup = sys->find_talkgroup(call->get_talkgroup());
 
@@ -533,6 +776,12 @@ void handle_call_grant(TrunkMessage message, System *sys, bool grant_message, Co
       BOOST_LOG_TRIVIAL(info) << loghdr << "\u001b[36mDuplicate Grant\u001b[0m - Not recording: " << grant_call_data << "- Original call: " << original_call_data;
     } else {
       recording_started = start_recorder(call, message, config, sys, sources);
+      if (!recording_started && (call->get_state() == MONITORING) && ((call->get_monitoring_state() == NO_RECORDER) || (call->get_monitoring_state() == NO_SOURCE))) {
+        Recorder_Pool::offload(call, message, sys);
+      }
+      if (!recording_started && config.recorder_preemption && (call->get_state() == MONITORING) && (call->get_monitoring_state() == NO_RECORDER) && preempt_recorder(call, sys, sources, calls)) {
+        recording_started = start_recorder(call, message, config, sys, sources);
+      }
       if (recording_started && !grant_message) {
         std::string loghdr = log_header( call->get_short_name(), call->get_call_num(), call->get_talkgroup_display(), call->get_freq());
         BOOST_LOG_TRIVIAL(info) << loghdr << "\u001b[36mThis was an UPDATE\u001b[0m";
@@ -588,6 +837,10 @@ void handle_message(std::vector<TrunkMessage> messages, System *sys, Config &con
   for (std::vector<TrunkMessage>::iterator it = messages.begin(); it != messages.end(); it++) {
     TrunkMessage message = *it;
 
+    if ((message.message_type == GRANT) || (message.message_type == UPDATE) || (message.message_type == UU_V_GRANT) || (message.message_type == UU_V_UPDATE)) {
+      Recorder_Pool::forward(message, sys);
+    }
+
     switch (message.message_type) {
     case GRANT:
       handle_call_grant(message, sys, true, config, sources, calls);
@@ -713,25 +966,39 @@ void retune_system(System *sys, gr::top_block_sptr &tb, std::vector<Source *> &s
         source_found = true;
         BOOST_LOG_TRIVIAL(info) << "\t - System Source " << source->get_num() << " - Min Freq: " << format_freq(source->get_min_hz()) << " Max Freq: " << format_freq(source->get_max_hz());
 
+        if ((system->get_system_type() != "smartnet") && (system->get_system_type() != "p25")) {
+          BOOST_LOG_TRIVIAL(error) << "\t - Unkown system type for Retune";
+          break;
+        }
+
+        if (system->get_control_channel_slot(source) == NULL) {
+          // The control channel was learned after startup and no decoder was
+          // built on this Source yet. Adding one has to modify the flow graph.
+          if (system->get_system_type() == "smartnet") {
+            // We must lock the flow graph in order to connect blocks
+            tb->lock();
+            setup_control_channel(system, source, control_channel_freq, tb);
+            tb->unlock();
+          } else {
+            tb->stop();
+            setup_control_channel(system, source, control_channel_freq, tb);
+            tb->start();
+          }
+
+          // Either way every block got a new thread
+          for (vector<Source *>::iterator it = sources.begin(); it != sources.end(); ++it) {
+            (*it)->apply_realtime_priority(tb);
+          }
+        }
+
+        // Both decoders are already connected, so switching Sources only
+        // flips selector ports and the other recorders keep running
+        select_control_channel_source(system, source);
         if (system->get_system_type() == "smartnet") {
-          system->set_source(source);
-          // We must lock the flow graph in order to disconnect and reconnect blocks
-          tb->lock();
-          tb->disconnect(current_source->get_src_block(), 0, system->smartnet_trunking, 0);
-          system->smartnet_trunking = make_smartnet_trunking(control_channel_freq, source->get_center(), source->get_rate(), system->get_msg_queue(), system->get_sys_num());
-          tb->connect(source->get_src_block(), 0, system->smartnet_trunking, 0);
-          tb->unlock();
+          system->smartnet_trunking->tune_freq(control_channel_freq);
           system->smartnet_trunking->reset();
-        } else if (system->get_system_type() == "p25") {
-          system->set_source(source);
-          // We must lock the flow graph in order to disconnect and reconnect blocks
-          tb->stop();
-          tb->disconnect(current_source->get_src_block(), 0, system->p25_trunking, 0);
-          system->p25_trunking = make_p25_trunking(control_channel_freq, source->get_center(), source->get_rate(), system->get_msg_queue(), system->get_qpsk_mod(), system->get_sys_num());
-          tb->connect(source->get_src_block(), 0, system->p25_trunking, 0);
-          tb->start();
         } else {
-          BOOST_LOG_TRIVIAL(error) << "\t - Unkown system type for Retune";
+          system->p25_trunking->tune_freq(control_channel_freq);
         }
 
         // break out of the For Loop
@@ -757,9 +1024,11 @@ void check_message_count(float timeDiff, Config &config, gr::top_block_sptr &tb,
   for (std::vector<System *>::iterator it = systems.begin(); it != systems.end(); ++it) {
     System_impl *sys = (System_impl *)*it;
 
-    if ((sys->get_system_type() != "conventional") && (sys->get_system_type() != "conventionalP25") && (sys->get_system_type() != "conventionalDMR") && (sys->get_system_type() != "conventionalSIGMF")) {
+    // Recorder Pool workers have no control channel to lose
+    if ((sys->get_system_type() != "conventional") && (sys->get_system_type() != "conventionalP25") && (sys->get_system_type() != "conventionalDMR") && (sys->get_system_type() != "conventionalSIGMF") && !Recorder_Pool::is_worker()) {
       int msgs_decoded_per_second = std::floor(sys->message_count / timeDiff);
       sys->set_decode_rate(msgs_decoded_per_second);
+      Metrics::for_system(sys)->decode_rate = msgs_decoded_per_second;
 
       if (msgs_decoded_per_second < 2) {
 
@@ -791,6 +1060,13 @@ void check_message_count(float timeDiff, Config &config, gr::top_block_sptr &tb,
       }
     }
     sys->message_count = 0;
+    sys->recorder_alloc_count = 0;
+    sys->recorder_alloc_usec = 0;
+    sys->recorder_alloc_max_usec = 0;
+    sys->preemption_count = 0;
+    sys->pretune_hit_count = 0;
+    sys->rejected_grant_count = 0;
+    sys->prune_rejected_talkgroups(rejected_talkgroup_timeout);
   }
 }
 
@@ -841,18 +1117,22 @@ int monitor_messages(Config &config, gr::top_block_sptr &tb, std::vector<Source
   time_t current_time = time(NULL);
   uint64_t current_time_ms = time_since_epoch_millisec();
   std::vector<TrunkMessage> trunk_messages;
+  std::vector<std::pair<System *, TrunkMessage>> pool_messages;
   SmartnetParser *smartnet_parser;
   P25Parser *p25_parser;
 
   signal(SIGINT, exit_interupt);
+  signal(SIGHUP, reload_interupt);
 
   smartnet_parser = new SmartnetParser(); // this has to eventually be generic;
   p25_parser = new P25Parser();
+  State_Snapshot::restore_freq_tables(p25_parser, systems);
 
   while (1) {
 
     if (exit_flag) { // my action when signal set it 1
       BOOST_LOG_TRIVIAL(info) << "Caught an Exit Signal...";
+      State_Snapshot::save(systems, calls, p25_parser);
       for (vector<Call *>::iterator it = calls.begin(); it != calls.end();) {
         Call *call = *it;
 
@@ -871,6 +1151,16 @@ int monitor_messages(Config &config, gr::top_block_sptr &tb, std::vector<Source
       return exit_code;
     }
 
+    if (reload_flag) {
+      reload_flag = 0;
+      if (reload_running.exchange(true)) {
+        BOOST_LOG_TRIVIAL(info) << "Caught a Reload Signal, but a reload is already running";
+      } else {
+        BOOST_LOG_TRIVIAL(info) << "Caught a Reload Signal, reloading Talkgroup and Unit Tag files";
+        std::thread(reload_tables, systems).detach();
+      }
+    }
+
     process_message_queues(systems);
     process_recorder_message_queues(calls);
 
@@ -884,6 +1174,7 @@ int monitor_messages(Config &config, gr::top_block_sptr &tb, std::vector<Source
         msg = system->get_msg_queue()->delete_head_nowait();
         while (msg != 0) {
           system->set_message_count(system->get_message_count() + 1);
+          Metrics::for_system(system)->control_messages++;
 
           if (system->get_system_type() == "smartnet") {
             trunk_messages = smartnet_parser->parse_message(msg->to_string(), system);
@@ -906,6 +1197,11 @@ int monitor_messages(Config &config, gr::top_block_sptr &tb, std::vector<Source
         }
       }
     }
+    Recorder_Pool::poll(systems, pool_messages);
+    for (std::vector<std::pair<System *, TrunkMessage>>::iterator it = pool_messages.begin(); it != pool_messages.end(); ++it) {
+      handle_message(std::vector<TrunkMessage>(1, it->second), it->first, config, sources, calls, tb);
+    }
+
     current_time = time(NULL);
     current_time_ms = time_since_epoch_millisec();
     if ((current_time_ms - last_conventional_channel_detection_check) >= 0.1) {
@@ -915,7 +1211,22 @@ int monitor_messages(Config &config, gr::top_block_sptr &tb, std::vector<Source
 
     if ((current_time - management_timestamp) >= 1.0) {
       manage_calls(config, calls);
+      if (config.pretune_recorders > 0) {
+        pretune_recorders(config, sources, systems);
+      }
       Call_Concluder::manage_call_data_workers();
+      Recorder_Pool::report_capacity(sources);
+      Recorder_Pool::manage_offloads(config.call_timeout);
+      State_Snapshot::update(systems, calls, p25_parser);
+      for (vector<System *>::iterator it = systems.begin(); it != systems.end(); ++it) {
+        ((System_impl *)*it)->free_retired_tables();
+      }
+      // Catches the threads a recorder replaces when it adds a demod chain,
+      // and any that weren't running yet when the flow graph started
+      for (vector<Source *>::iterator it = sources.begin(); it != sources.end(); ++it) {
+        (*it)->apply_realtime_priority(tb);
+      }
+      Flowgraph_Stats::update(sources, systems);
       management_timestamp = current_time;
     }
 
@@ -925,6 +1236,7 @@ int monitor_messages(Config &config, gr::top_block_sptr &tb, std::vector<Source
 
     if (decode_rate_check_time_diff >= 3.0) {
       check_message_count(decode_rate_check_time_diff, config, tb, sources, systems);
+      Metrics::update_recorders(sources);
       for (vector<Source *>::iterator src_it = sources.begin(); src_it != sources.end(); src_it++) {
         Source *source = *src_it;
         if (!source->got_samples()) {
@@ -21,6 +21,15 @@ typedef enum {
 
 using json = nlohmann::json;
 
+// Bumped whenever a Plugin_Api method changes its signature, or a method is
+// added. A plugin still written against an older version can check it, since
+// a method with the old signature no longer overrides anything and is never
+// called. New methods go at the end, so the vtable slots of the older ones
+// stay where they were.
+//   2: call_end takes a const Call_Data_t &
+//   3: block_stats added
+#define PLUGIN_API_VERSION 3
+
 class Plugin_Api {
 public:
   virtual int init(Config *config, std::vector<Source *> sources, std::vector<System *> systems) { frequency_format = config->frequency_format; return 0; };
@@ -32,7 +41,7 @@ public:
   virtual int audio_stream(Call *call, Recorder *recorder, int16_t *samples, int sampleCount) { return 0; };
   virtual int trunk_message(std::vector<TrunkMessage> messages, System *system) { return 0; };
   virtual int call_start(Call *call) { return 0; };
-  virtual int call_end(Call_Data_t call_info) { return 0; }; //= 0; //{ BOOST_LOG_TRIVIAL(info) << "plugin_api call_end"; return 0; };
+  virtual int call_end(const Call_Data_t &call_info) { return 0; }; //= 0; //{ BOOST_LOG_TRIVIAL(info) << "plugin_api call_end"; return 0; };
   virtual int calls_active(std::vector<Call *> calls) { return 0; };
   virtual int setup_recorder(Recorder *recorder) { return 0; };
   virtual int setup_system(System *system) { return 0; };
@@ -47,6 +56,7 @@ public:
   virtual int unit_data_grant(System *sys, long source_id) { return 0; };
   virtual int unit_answer_request(System *sys, long source_id, long talkgroup) { return 0; };
   virtual int unit_location(System *sys, long source_id, long talkgroup_num) { return 0; };
+  virtual int block_stats(const std::vector<Block_Stats> &stats, float timeDiff) { return 0; };
   //void set_frequency_format(int f) { frequencyFormat = f; }
   virtual ~Plugin_Api(){};
 };
@@ -279,6 +279,15 @@ void plugman_system_rates(std::vector<System *> systems, float timeDiff) {
   }
 }
 
+void plugman_block_stats(const std::vector<Block_Stats> &stats, float timeDiff) {
+  for (std::vector<Plugin *>::iterator it = plugins.begin(); it != plugins.end(); it++) {
+    Plugin *plugin = *it;
+    if (plugin->state == PLUGIN_RUNNING) {
+      plugin->api->block_stats(stats, timeDiff);
+    }
+  }
+}
+
 void plugman_unit_registration(System *system, long source_id) {
   for (std::vector<Plugin *>::iterator it = plugins.begin(); it != plugins.end(); it++) {
     Plugin *plugin = *it;
@@ -43,6 +43,7 @@ void plugman_setup_systems(std::vector<System *> systems);
 void plugman_setup_sources(std::vector<Source *> sources);
 void plugman_setup_config(std::vector<Source *> sources, std::vector<System *> systems);
 void plugman_system_rates(std::vector<System *> systems, float timeDiff);
+void plugman_block_stats(const std::vector<Block_Stats> &stats, float timeDiff);
 void plugman_unit_registration(System *system, long source_id);
 void plugman_unit_deregistration(System *system, long source_id);
 void plugman_unit_acknowledge_response(System *system, long source_id);
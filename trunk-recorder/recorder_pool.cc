@@ -0,0 +1,415 @@
+#include "recorder_pool.h"
+#include "call.h"
+#include "call_concluder/call_journal.h"
+#include "formatter.h"
+#include "source.h"
+#include "systems/system.h"
+#include <algorithm>
+#include <boost/log/trivial.hpp>
+#include <cerrno>
+#include <json.hpp>
+#include <sys/socket.h>
+#include <thread>
+
+using json = nlohmann::json;
+
+bool Recorder_Pool::controller = false;
+bool Recorder_Pool::worker = false;
+std::string Recorder_Pool::instance_id = "";
+boost::asio::io_service Recorder_Pool::service;
+std::mutex Recorder_Pool::pool_mutex;
+std::vector<std::shared_ptr<Recorder_Pool::Worker_Connection>> Recorder_Pool::workers = {};
+std::vector<Recorder_Pool::Offload> Recorder_Pool::offloads = {};
+std::shared_ptr<boost::asio::ip::tcp::socket> Recorder_Pool::controller_socket;
+std::vector<std::pair<std::string, TrunkMessage>> Recorder_Pool::inbound = {};
+
+// Larger than any message either end sends, to catch a connection that has
+// lost its framing
+static const uint32_t MAX_FRAME = 1 << 20;
+
+static json message_to_json(const std::string &short_name, const TrunkMessage &message) {
+  return json{
+      {"type", "message"},
+      {"shortName", short_name},
+      {"messageType", (int)message.message_type},
+      {"freq", message.freq},
+      {"talkgroup", message.talkgroup},
+      {"encrypted", message.encrypted},
+      {"emergency", message.emergency},
+      {"duplex", message.duplex},
+      {"mode", message.mode},
+      {"priority", message.priority},
+      {"tdmaSlot", message.tdma_slot},
+      {"phase2Tdma", message.phase2_tdma},
+      {"source", message.source},
+      {"sysId", message.sys_id},
+      {"sysRfss", message.sys_rfss},
+      {"sysSiteId", message.sys_site_id},
+      {"nac", message.nac},
+      {"wacn", message.wacn},
+      {"opcode", message.opcode}};
+}
+
+static TrunkMessage message_from_json(const json &data) {
+  TrunkMessage message = {};
+  message.message_type = (MessageType)data.value("messageType", (int)UNKNOWN);
+  message.freq = data.value("freq", 0.0);
+  message.talkgroup = data.value("talkgroup", 0L);
+  message.encrypted = data.value("encrypted", false);
+  message.emergency = data.value("emergency", false);
+  message.duplex = data.value("duplex", false);
+  message.mode = data.value("mode", false);
+  message.priority = data.value("priority", 0);
+  message.tdma_slot = data.value("tdmaSlot", 0);
+  message.phase2_tdma = data.value("phase2Tdma", false);
+  message.source = data.value("source", -1L);
+  message.sys_id = data.value("sysId", 0UL);
+  message.sys_rfss = data.value("sysRfss", 0);
+  message.sys_site_id = data.value("sysSiteId", 0);
+  message.nac = data.value("nac", 0UL);
+  message.wacn = data.value("wacn", 0UL);
+  message.opcode = data.value("opcode", 0UL);
+  return message;
+}
+
+void Recorder_Pool::init(Config &config, std::vector<System *> &systems) {
+  instance_id = config.instance_id;
+
+  if (config.recorder_pool_port > 0) {
+    controller = true;
+    BOOST_LOG_TRIVIAL(info) << "Recorder Pool: accepting workers on " << config.recorder_pool_address << ":" << config.recorder_pool_port;
+    std::thread(serve, config.recorder_pool_address, config.recorder_pool_port).detach();
+  }
+
+  if (config.recorder_pool_controller != "") {
+    worker = true;
+    BOOST_LOG_TRIVIAL(info) << "Recorder Pool: recording calls for the controller at " << config.recorder_pool_controller;
+    std::thread(connect_to_controller, config.recorder_pool_controller).detach();
+  }
+}
+
+// Sends are made from the monitor thread with pool_mutex held, so they never
+// wait. A frame that doesn't fit in the socket's send buffer in one go means
+// the other end has stopped reading, and since part of it may already be on
+// the wire the connection can't be used again.
+bool Recorder_Pool::send_frame(boost::asio::ip::tcp::socket &socket, char type, const std::string &payload) {
+  uint32_t length = payload.size() + 1;
+  std::string frame;
+  frame.reserve(payload.size() + 5);
+  frame.push_back((char)(length));
+  frame.push_back((char)(length >> 8));
+  frame.push_back((char)(length >> 16));
+  frame.push_back((char)(length >> 24));
+  frame.push_back(type);
+  frame.append(payload);
+
+  ssize_t sent;
+  do {
+    sent = ::send(socket.native_handle(), frame.data(), frame.size(), MSG_DONTWAIT | MSG_NOSIGNAL);
+  } while ((sent < 0) && (errno == EINTR));
+  return sent == (ssize_t)frame.size();
+}
+
+bool Recorder_Pool::read_frame(boost::asio::ip::tcp::socket &socket, char &type, std::string &payload) {
+  unsigned char frame_header[5];
+  boost::system::error_code ec;
+
+  boost::asio::read(socket, boost::asio::buffer(frame_header, sizeof(frame_header)), ec);
+  if (ec) {
+    return false;
+  }
+  uint32_t length = frame_header[0] | (frame_header[1] << 8) | (frame_header[2] << 16) | ((uint32_t)frame_header[3] << 24);
+  if ((length < 1) || (length > MAX_FRAME)) {
+    return false;
+  }
+  type = frame_header[4];
+  payload.resize(length - 1);
+  boost::asio::read(socket, boost::asio::buffer(&payload[0], payload.size()), ec);
+  return !ec;
+}
+
+static void set_no_delay(boost::asio::ip::tcp::socket &socket) {
+  boost::system::error_code ec;
+  socket.set_option(boost::asio::ip::tcp::no_delay(true), ec);
+}
+
+/* -- Controller -- */
+
+void Recorder_Pool::serve(std::string address, int port) {
+  boost::asio::ip::tcp::acceptor acceptor(service);
+  int next_id = 1;
+
+  try {
+    boost::asio::ip::tcp::endpoint endpoint(boost::asio::ip::address::from_string(address), port);
+    acceptor.open(endpoint.protocol());
+    acceptor.set_option(boost::asio::ip::tcp::acceptor::reuse_address(true));
+    acceptor.bind(endpoint);
+    acceptor.listen();
+  } catch (std::exception &e) {
+    BOOST_LOG_TRIVIAL(error) << "Recorder Pool: unable to listen on " << address << ":" << port << " - " << e.what();
+    return;
+  }
+
+  while (1) {
+    std::shared_ptr<boost::asio::ip::tcp::socket> socket(new boost::asio::ip::tcp::socket(service));
+    boost::system::error_code ec;
+
+    acceptor.accept(*socket, ec);
+    if (ec) {
+      continue;
+    }
+    set_no_delay(*socket);
+
+    std::shared_ptr<Worker_Connection> connection(new Worker_Connection());
+    connection->id = next_id++;
+    connection->socket = socket;
+    connection->connected = true;
+    std::thread(read_worker, connection).detach();
+  }
+}
+
+void Recorder_Pool::read_worker(std::shared_ptr<Worker_Connection> connection) {
+  char type;
+  std::string payload;
+  std::string name = "worker " + std::to_string(connection->id);
+
+  while (read_frame(*connection->socket, type, payload)) {
+    if (type == 'C') {
+      Call_Data_t call_info = {};
+      if (!Call_Journal::decode(payload, call_info)) {
+        BOOST_LOG_TRIVIAL(error) << "Recorder Pool: " << name << " sent a call that could not be read";
+        continue;
+      }
+      std::string loghdr = log_header(call_info.short_name, call_info.call_num, std::to_string(call_info.talkgroup), call_info.freq);
+      BOOST_LOG_TRIVIAL(info) << loghdr << "Recorded by " << name << " - length: " << format_time(call_info.length) << " units: " << call_info.transmission_source_list.size();
+      Call_Journal::append(call_info);
+      continue;
+    }
+
+    json data = json::parse(payload, nullptr, false);
+    if ((type != 'J') || data.is_discarded()) {
+      continue;
+    }
+
+    std::string message_type = data.value("type", "");
+    if (message_type == "hello") {
+      name = data.value("name", name);
+      BOOST_LOG_TRIVIAL(info) << "Recorder Pool: " << name << " connected";
+      std::lock_guard<std::mutex> lock(pool_mutex);
+      connection->name = name;
+      workers.push_back(connection);
+    } else if (message_type == "capacity") {
+      std::vector<Source_Capacity> capacity;
+      for (json &source : data["sources"]) {
+        capacity.push_back({source.value("minHz", 0.0), source.value("maxHz", 0.0), source.value("digital", 0), source.value("analog", 0)});
+      }
+      std::lock_guard<std::mutex> lock(pool_mutex);
+      connection->capacity = capacity;
+    }
+  }
+
+  BOOST_LOG_TRIVIAL(error) << "Recorder Pool: " << name << " disconnected";
+  std::lock_guard<std::mutex> lock(pool_mutex);
+  connection->connected = false;
+  workers.erase(std::remove(workers.begin(), workers.end(), connection), workers.end());
+  offloads.erase(std::remove_if(offloads.begin(), offloads.end(), [&](const Offload &offload) { return offload.worker_id == connection->id; }), offloads.end());
+}
+
+bool Recorder_Pool::send_to_worker(Worker_Connection &connection, const std::string &short_name, TrunkMessage &message) {
+  if (!connection.connected) {
+    return false;
+  }
+  if (!send_frame(*connection.socket, 'J', message_to_json(short_name, message).dump())) {
+    BOOST_LOG_TRIVIAL(error) << "Recorder Pool: " << connection.name << " is not keeping up, dropping it";
+    drop_worker(connection);
+    return false;
+  }
+  return true;
+}
+
+// Called with pool_mutex held. The worker's reader thread sees the shutdown
+// and removes it from the list of workers.
+void Recorder_Pool::drop_worker(Worker_Connection &connection) {
+  connection.connected = false;
+  boost::system::error_code ec;
+  connection.socket->shutdown(boost::asio::ip::tcp::socket::shutdown_both, ec);
+  offloads.erase(std::remove_if(offloads.begin(), offloads.end(), [&](const Offload &offload) { return offload.worker_id == connection.id; }), offloads.end());
+}
+
+bool Recorder_Pool::offload(Call *call, TrunkMessage &message, System *sys) {
+  if (!controller) {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(pool_mutex);
+  double freq = call->get_freq();
+
+  for (std::vector<std::shared_ptr<Worker_Connection>>::iterator it = workers.begin(); it != workers.end(); ++it) {
+    Worker_Connection &connection = **it;
+
+    for (std::vector<Source_Capacity>::iterator cap = connection.capacity.begin(); cap != connection.capacity.end(); ++cap) {
+      int &available = call->get_is_analog() ? cap->analog : cap->digital;
+      if ((cap->min_hz > freq) || (cap->max_hz < freq) || (available < 1)) {
+        continue;
+      }
+      if (!send_to_worker(connection, sys->get_short_name(), message)) {
+        break;
+      }
+
+      // Counted as taken until the worker's next report
+      available--;
+      offloads.push_back({connection.id, sys->get_short_name(), message.talkgroup, message.freq, message.tdma_slot, message.phase2_tdma, time(NULL)});
+
+      std::string loghdr = log_header(call->get_short_name(), call->get_call_num(), call->get_talkgroup_display(), call->get_freq());
+      BOOST_LOG_TRIVIAL(info) << loghdr << "\u001b[36mOffloaded to " << connection.name << "\u001b[0m";
+      call->set_state(MONITORING);
+      call->set_monitoring_state(OFFLOADED);
+      return true;
+    }
+  }
+  return false;
+}
+
+void Recorder_Pool::forward(TrunkMessage &message, System *sys) {
+  if (!controller) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(pool_mutex);
+  if (offloads.empty()) {
+    return;
+  }
+
+  for (std::vector<Offload>::iterator it = offloads.begin(); it != offloads.end(); ++it) {
+    if ((it->talkgroup != message.talkgroup) || (it->freq != message.freq) || (it->tdma_slot != message.tdma_slot) || (it->phase2_tdma != message.phase2_tdma) || (it->short_name != sys->get_short_name())) {
+      continue;
+    }
+    it->last_seen = time(NULL);
+
+    for (std::vector<std::shared_ptr<Worker_Connection>>::iterator worker_it = workers.begin(); worker_it != workers.end(); ++worker_it) {
+      if ((*worker_it)->id == it->worker_id) {
+        // it is not used again, since dropping the worker ends its offloads
+        send_to_worker(**worker_it, it->short_name, message);
+        break;
+      }
+    }
+    return;
+  }
+}
+
+void Recorder_Pool::manage_offloads(double call_timeout) {
+  if (!controller) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(pool_mutex);
+  time_t now = time(NULL);
+  offloads.erase(std::remove_if(offloads.begin(), offloads.end(), [&](const Offload &offload) { return (now - offload.last_seen) > call_timeout; }), offloads.end());
+}
+
+/* -- Worker -- */
+
+void Recorder_Pool::connect_to_controller(std::string controller_address) {
+  std::string host = controller_address;
+  std::string port = "";
+  size_t colon = controller_address.rfind(':');
+  if (colon != std::string::npos) {
+    host = controller_address.substr(0, colon);
+    port = controller_address.substr(colon + 1);
+  }
+
+  while (1) {
+    std::shared_ptr<boost::asio::ip::tcp::socket> socket(new boost::asio::ip::tcp::socket(service));
+    boost::system::error_code ec;
+    boost::asio::ip::tcp::resolver resolver(service);
+    boost::asio::connect(*socket, resolver.resolve(boost::asio::ip::tcp::resolver::query(host, port), ec), ec);
+
+    if (!ec) {
+      set_no_delay(*socket);
+      json hello = {{"type", "hello"}, {"name", instance_id != "" ? instance_id : "worker " + std::to_string(getpid())}};
+      if (send_frame(*socket, 'J', hello.dump())) {
+        BOOST_LOG_TRIVIAL(info) << "Recorder Pool: connected to the controller at " << controller_address;
+        {
+          std::lock_guard<std::mutex> lock(pool_mutex);
+          controller_socket = socket;
+        }
+
+        char type;
+        std::string payload;
+        while (read_frame(*socket, type, payload)) {
+          json data = json::parse(payload, nullptr, false);
+          if ((type != 'J') || data.is_discarded() || (data.value("type", "") != "message")) {
+            continue;
+          }
+          std::lock_guard<std::mutex> lock(pool_mutex);
+          inbound.push_back(std::make_pair(data.value("shortName", ""), message_from_json(data)));
+        }
+
+        std::lock_guard<std::mutex> lock(pool_mutex);
+        controller_socket.reset();
+      }
+      BOOST_LOG_TRIVIAL(error) << "Recorder Pool: lost the connection to the controller at " << controller_address;
+    }
+
+    std::this_thread::sleep_for(std::chrono::seconds(5));
+  }
+}
+
+void Recorder_Pool::poll(std::vector<System *> &systems, std::vector<std::pair<System *, TrunkMessage>> &messages) {
+  messages.clear();
+  if (!worker) {
+    return;
+  }
+
+  std::vector<std::pair<std::string, TrunkMessage>> received;
+  {
+    std::lock_guard<std::mutex> lock(pool_mutex);
+    received.swap(inbound);
+  }
+
+  for (std::vector<std::pair<std::string, TrunkMessage>>::iterator it = received.begin(); it != received.end(); ++it) {
+    for (std::vector<System *>::iterator sys_it = systems.begin(); sys_it != systems.end(); ++sys_it) {
+      System *sys = *sys_it;
+      if (sys->get_short_name() == it->first) {
+        it->second.sys_num = sys->get_sys_num();
+        messages.push_back(std::make_pair(sys, it->second));
+        break;
+      }
+    }
+  }
+}
+
+void Recorder_Pool::report_capacity(std::vector<Source *> &sources) {
+  if (!worker) {
+    return;
+  }
+
+  json report = {{"type", "capacity"}, {"sources", json::array()}};
+  for (std::vector<Source *>::iterator it = sources.begin(); it != sources.end(); ++it) {
+    Source *source = *it;
+    report["sources"].push_back({{"minHz", source->get_min_hz()}, {"maxHz", source->get_max_hz()}, {"digital", source->get_num_available_digital_recorders()}, {"analog", source->get_num_available_analog_recorders()}});
+  }
+
+  std::lock_guard<std::mutex> lock(pool_mutex);
+  if (controller_socket && !send_frame(*controller_socket, 'J', report.dump())) {
+    BOOST_LOG_TRIVIAL(error) << "Recorder Pool: the controller is not keeping up, dropping the connection";
+    boost::system::error_code ec;
+    controller_socket->shutdown(boost::asio::ip::tcp::socket::shutdown_both, ec);
+  }
+}
+
+void Recorder_Pool::call_concluded(const Call_Data_t &call_info) {
+  if (!worker) {
+    return;
+  }
+
+  std::string record;
+  Call_Journal::encode(call_info, record);
+
+  std::lock_guard<std::mutex> lock(pool_mutex);
+  if (controller_socket && !send_frame(*controller_socket, 'C', record)) {
+    BOOST_LOG_TRIVIAL(error) << "Recorder Pool: unable to send Call " << call_info.call_num << " to the controller, dropping the connection";
+    boost::system::error_code ec;
+    controller_socket->shutdown(boost::asio::ip::tcp::socket::shutdown_both, ec);
+  }
+}
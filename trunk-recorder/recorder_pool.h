@@ -0,0 +1,103 @@
+#ifndef RECORDER_POOL_H
+#define RECORDER_POOL_H
+
+#include <boost/asio.hpp>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "./global_structs.h"
+#include "systems/parser.h"
+
+class Call;
+class Source;
+class System;
+
+/*
+ * Spreads call recording over several trunk-recorder processes.
+ *
+ * The controller decodes the control channels. When it can't record a grant
+ * itself, because none of its recorders are free or none of its Sources cover
+ * the frequency, it hands the grant to a worker that has a free recorder on a
+ * Source covering it. The grant and every later GRANT or UPDATE for that call
+ * are forwarded to that worker, which records and concludes the call as if it
+ * had decoded them itself. Each concluded call is sent back to the controller,
+ * which logs it and adds it to its Call Journal.
+ *
+ * Workers usually get their samples from the controller's SDRs over an IQ
+ * Bus, so a controller and its workers share a host, but any worker with its
+ * own Sources covering the frequencies works too.
+ *
+ * Messages on the connection are framed as a uint32 length, little endian,
+ * then a type byte: 'J' for a JSON object or 'C' for a Call Journal record.
+ */
+class Recorder_Pool {
+
+public:
+  static void init(Config &config, std::vector<System *> &systems);
+  static bool is_controller() { return controller; }
+  static bool is_worker() { return worker; }
+
+  // Controller: hands a call that could not be recorded here to a worker.
+  // Returns false if no worker could take it.
+  static bool offload(Call *call, TrunkMessage &message, System *sys);
+  // Controller: passes GRANTs and UPDATEs on to the worker recording the call
+  static void forward(TrunkMessage &message, System *sys);
+  // Controller: forgets calls that have gone quiet
+  static void manage_offloads(double call_timeout);
+
+  // Worker: the messages the controller has forwarded since the last call
+  static void poll(std::vector<System *> &systems, std::vector<std::pair<System *, TrunkMessage>> &messages);
+  // Worker: tells the controller how many recorders are free on each Source
+  static void report_capacity(std::vector<Source *> &sources);
+  // Worker: sends a concluded call back to the controller
+  static void call_concluded(const Call_Data_t &call_info);
+
+private:
+  struct Source_Capacity {
+    double min_hz;
+    double max_hz;
+    int digital;
+    int analog;
+  };
+
+  struct Worker_Connection {
+    int id;
+    std::string name;
+    std::shared_ptr<boost::asio::ip::tcp::socket> socket;
+    std::vector<Source_Capacity> capacity;
+    bool connected;
+  };
+
+  struct Offload {
+    int worker_id;
+    std::string short_name;
+    long talkgroup;
+    double freq;
+    int tdma_slot;
+    bool phase2_tdma;
+    time_t last_seen;
+  };
+
+  static bool controller;
+  static bool worker;
+  static std::string instance_id;
+  static boost::asio::io_service service;
+  static std::mutex pool_mutex;
+  static std::vector<std::shared_ptr<Worker_Connection>> workers;
+  static std::vector<Offload> offloads;
+  static std::shared_ptr<boost::asio::ip::tcp::socket> controller_socket;
+  static std::vector<std::pair<std::string, TrunkMessage>> inbound;
+
+  static bool send_frame(boost::asio::ip::tcp::socket &socket, char type, const std::string &payload);
+  static bool read_frame(boost::asio::ip::tcp::socket &socket, char &type, std::string &payload);
+  static bool send_to_worker(Worker_Connection &worker, const std::string &short_name, TrunkMessage &message);
+  static void drop_worker(Worker_Connection &worker);
+
+  static void serve(std::string address, int port);
+  static void read_worker(std::shared_ptr<Worker_Connection> worker);
+  static void connect_to_controller(std::string controller);
+};
+
+#endif
@@ -17,24 +17,13 @@ std::vector<float> design_filter(double interpolation, double deci) {
   float trans_width = 0.5 - 0.4;
   float mid_transition_band = 0.5 - trans_width / 2;
 
-#if GNURADIO_VERSION < 0x030900
-  std::vector<float> result = gr::filter::firdes::low_pass(
+  return filter_cache::low_pass(
       interpolation,
       1,
       mid_transition_band / interpolation,
       trans_width / interpolation,
-      gr::filter::firdes::WIN_KAISER,
+      filter_window_t::WIN_KAISER,
       beta);
-#else
-  std::vector<float> result = gr::filter::firdes::low_pass(
-      interpolation,
-      1,
-      mid_transition_band / interpolation,
-      trans_width / interpolation,
-      gr::fft::window::WIN_KAISER,
-      beta);
-#endif
-  return result;
 }
 
 analog_recorder_sptr make_analog_recorder(Source *src, Recorder_Type type) {
@@ -51,6 +40,9 @@ void analog_recorder::set_tau(float tau) {
   if (deemph) {
     deemph->set_taps(d_fftaps, d_fbtaps);
   }
+  if (fused_demod) {
+    fused_demod->set_deemph_taps(d_fftaps, d_fbtaps);
+  }
 }
 
 float analog_recorder::get_tau() const {
@@ -117,8 +109,12 @@ analog_recorder::analog_recorder(Source *src, System *system, Recorder_Type type
     this->tone_freq = 0;
   }
 
+  use_fused_demod = false;
   if (config != NULL) {
     use_streaming = config->enable_audio_streaming;
+    // The CTCSS squelch has to sit between de-emphasis and decimation, so
+    // tone squelched channels keep the block-per-stage chain
+    use_fused_demod = config->fused_analog_demod && !use_tone_squelch;
   }
 
   if (type == ANALOGC) {
@@ -136,37 +132,28 @@ analog_recorder::analog_recorder(Source *src, System *system, Recorder_Type type
   prefilter = xlat_channelizer::make(input_rate, samp_per_sym, system_channel_rate / samp_per_sym, bandwidth, center_freq, true);
   prefilter->set_analog_squelch(true);
 
-  //  based on squelch code form ham2mon
-  // set low -200 since its after demod and its just gate for previous squelch so that the audio
-  // recording doesn't contain blank spaces between transmissions
-  squelch_two = gr::analog::pwr_squelch_ff::make(-200, 0.01, 0, true);
-
-  if (use_tone_squelch) {
-    tone_squelch = gr::analog::ctcss_squelch_ff::make(system_channel_rate, this->tone_freq, 0.01, 0, 0, false);
-  }
   // k = quad_rate/(2*math.pi*max_dev) = 48k / (6.283185*5000) = 1.527
 
   int d_max_dev = 5000;
   /* demodulator gain */
   quad_gain = system_channel_rate / (2.0 * M_PI * d_max_dev);
-  demod = gr::analog::quadrature_demod_cf::make(quad_gain);
-  levels = gr::blocks::multiply_const_ff::make(1); // 33);
-  converter = gr::blocks::float_to_short::make(1, 32767);
 
   /* de-emphasis */
   d_tau = (system != nullptr) ? system->get_tau() : 0.000075f;  // Default to 75us if system is not provided
   d_fftaps.resize(2);
   d_fbtaps.resize(2);
   calculate_iir_taps(d_tau);
-  deemph = gr::filter::iir_filter_ffd::make(d_fftaps, d_fbtaps, false);
 
   audio_resampler_taps = design_filter(1, (system_channel_rate / wav_sample_rate)); // Calculated to make sample rate changable -- must be an integer
 
   BOOST_LOG_TRIVIAL(info) << "Audio Resampler Taps: " << audio_resampler_taps.size() << " Decimation: " << (system_channel_rate / wav_sample_rate);
-  // downsample from 48k to 8k
-  decim_audio = gr::filter::fir_filter_fff::make((system_channel_rate / wav_sample_rate), audio_resampler_taps); // Calculated to make sample rate changable
 
-  // tm *ltm = localtime(&starttime);
+  // Analog audio band pass from 300 to 3000 Hz
+  // can't use gnuradio.filter.firdes.band_pass since we have different transition widths
+  // 300 Hz high pass (275-325 Hz): removes CTCSS/DCS and Type II 150 bps Low Speed Data (LSD), or "FSK wobble"
+  high_f_taps = filter_cache::high_pass(1, wav_sample_rate, 300, 50, filter_window_t::WIN_HANN); // Configurable
+  // 3000 Hz low pass (3000-3500 Hz)
+  low_f_taps = filter_cache::low_pass(1, wav_sample_rate, 3250, 500, filter_window_t::WIN_HANN);
 
   wav_sink = gr::blocks::transmission_sink::make(1, wav_sample_rate, 16); //  Configurable
 
@@ -180,24 +167,43 @@ analog_recorder::analog_recorder(Source *src, System *system, Recorder_Type type
   decoder_sink = gr::blocks::decoder_wrapper_impl::make(wav_sample_rate, std::bind(&analog_recorder::decoder_callback_handler, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
   BOOST_LOG_TRIVIAL(info) << "\t Decoder sink created!" << std::endl;
 
-  // Analog audio band pass from 300 to 3000 Hz
-  // can't use gnuradio.filter.firdes.band_pass since we have different transition widths
-  // 300 Hz high pass (275-325 Hz): removes CTCSS/DCS and Type II 150 bps Low Speed Data (LSD), or "FSK wobble"
-#if GNURADIO_VERSION < 0x030900
-  high_f_taps = gr::filter::firdes::high_pass(1, wav_sample_rate, 300, 50, gr::filter::firdes::WIN_HANN); // Configurable
-  low_f_taps = gr::filter::firdes::low_pass(1, wav_sample_rate, 3250, 500, gr::filter::firdes::WIN_HANN);
-#else
-  high_f_taps = gr::filter::firdes::high_pass(1, wav_sample_rate, 300, 50, gr::fft::window::WIN_HANN); // Configurable
-  low_f_taps = gr::filter::firdes::low_pass(1, wav_sample_rate, 3250, 500, gr::fft::window::WIN_HANN);
-#endif
+  connect(self(), 0, prefilter, 0);
 
-  high_f = gr::filter::fir_filter_fff::make(1, high_f_taps);
-  // 3000 Hz low pass (3000-3500 Hz)
+  if (use_fused_demod) {
+    // demod, de-emphasis, decimation, band pass, gate, levels and conversion in one block
+    fused_demod = gr::blocks::fm_audio_demod::make(quad_gain, d_fftaps, d_fbtaps, (system_channel_rate / wav_sample_rate), audio_resampler_taps, high_f_taps, low_f_taps, 1, -200, 0.01);
+
+    connect(prefilter, 0, fused_demod, 0);
+    connect(fused_demod, 0, decoder_sink, 0);
+    connect(fused_demod, 1, wav_sink, 0);
+
+    if (use_streaming) {
+      connect(fused_demod, 1, plugin_sink, 0);
+    }
+    return;
+  }
+
+  //  based on squelch code form ham2mon
+  // set low -200 since its after demod and its just gate for previous squelch so that the audio
+  // recording doesn't contain blank spaces between transmissions
+  squelch_two = gr::analog::pwr_squelch_ff::make(-200, 0.01, 0, true);
 
+  if (use_tone_squelch) {
+    tone_squelch = gr::analog::ctcss_squelch_ff::make(system_channel_rate, this->tone_freq, 0.01, 0, 0, false);
+  }
+
+  demod = gr::analog::quadrature_demod_cf::make(quad_gain);
+  levels = gr::blocks::multiply_const_ff::make(1); // 33);
+  converter = gr::blocks::float_to_short::make(1, 32767);
+  deemph = gr::filter::iir_filter_ffd::make(d_fftaps, d_fbtaps, false);
+
+  // downsample from 48k to 8k
+  decim_audio = gr::filter::fir_filter_fff::make((system_channel_rate / wav_sample_rate), audio_resampler_taps); // Calculated to make sample rate changable
+
+  high_f = gr::filter::fir_filter_fff::make(1, high_f_taps);
   low_f = gr::filter::fir_filter_fff::make(1, low_f_taps);
 
   // using squelch
-  connect(self(), 0, prefilter, 0);
   connect(prefilter, 0, demod, 0);
   connect(demod, 0, deemph, 0);
   if (use_tone_squelch) {
@@ -247,6 +253,7 @@ void analog_recorder::stop() {
     state = INACTIVE;
     set_enabled(false);
     wav_sink->stop_recording();
+    source->release_recorder(this);
   } else {
 
     BOOST_LOG_TRIVIAL(error) << "analog_recorder.cc: Stopping an inactive Logger \t[ " << rec_num << " ] - freq[ " << format_freq(chan_freq) << "] \t talkgroup[ " << talkgroup << " ]";
@@ -374,11 +381,16 @@ bool analog_recorder::start(Call *call) {
 
   // BOOST_LOG_TRIVIAL(error) << "Setting squelch to: " << squelch_db << " block says: " << squelch->threshold();
   
-  levels->set_k(system->get_analog_levels());
   int d_max_dev = system->get_max_dev();
   prefilter->set_max_dev(d_max_dev);
   quad_gain = system_channel_rate / (2.0 * M_PI * (d_max_dev + 1000));
-  demod->set_gain(quad_gain);
+  if (use_fused_demod) {
+    fused_demod->set_level(system->get_analog_levels());
+    fused_demod->set_gain(quad_gain);
+  } else {
+    levels->set_k(system->get_analog_levels());
+    demod->set_gain(quad_gain);
+  }
   int offset_amount = (center_freq - chan_freq);
   prefilter->tune_offset(offset_amount);
 
@@ -47,6 +47,7 @@ class analog_recorder;
 
 #include "../gr_blocks/channelizer.h"
 #include "../gr_blocks/decoder_wrapper.h"
+#include "../gr_blocks/fm_audio_demod.h"
 #include "../gr_blocks/freq_xlating_fft_filter.h"
 #include "../gr_blocks/plugin_wrapper.h"
 #include "../gr_blocks/transmission_sink.h"
@@ -121,6 +122,7 @@ private:
   time_t timestamp;
   time_t starttime;
   bool use_tone_squelch;
+  bool use_fused_demod;
 
   State state;
   std::vector<float> channel_lpf_taps;
@@ -157,6 +159,7 @@ private:
 
   gr::analog::quadrature_demod_cf::sptr demod;
   gr::blocks::float_to_short::sptr converter;
+  gr::blocks::fm_audio_demod::sptr fused_demod;
 
   gr::blocks::transmission_sink::sptr wav_sink;
   gr::blocks::decoder_wrapper::sptr decoder_sink;
@@ -44,6 +44,9 @@ public:
   virtual void switch_tdma(bool phase2) = 0;
   virtual void set_tdma_slot(int slot) = 0;
   virtual void set_source(long src) = 0;
+  virtual bool park(double f, bool qpsk_mod) = 0;
+  virtual void unpark() = 0;
+  virtual double get_parked_freq() = 0;
   virtual double since_last_write() = 0;
   virtual void process_message_queues() = 0;
   virtual double get_current_length() = 0;
@@ -29,6 +29,8 @@ void p25_recorder_decode::stop() {
 
 void p25_recorder_decode::start(Call *call) {
   levels->set_k(call->get_system()->get_digital_levels());
+  // anything queued while the recorder was pre-tuned belongs to an earlier call
+  rx_queue->flush();
 
   if(call->get_phase2_tdma()){
     wav_sink->start_recording(call, call->get_tdma_slot());
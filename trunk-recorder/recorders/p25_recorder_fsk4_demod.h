@@ -21,6 +21,7 @@
 #include <gnuradio/blocks/multiply_const.h>
 #include <gnuradio/filter/fir_filter_blk.h>
 #endif
+#include "../gr_blocks/filter_cache.h"
 #include "../gr_blocks/rms_agc.h"
 #include <op25_repeater/fsk4_slicer_fb.h>
 #include <op25_repeater/rmsagc_ff.h>
@@ -51,21 +51,48 @@ void p25_recorder_impl::initialize(Source *src) {
   }
 
   prefilter = xlat_channelizer::make(input_rate, channelizer::phase1_samples_per_symbol, channelizer::phase1_symbol_rate, xlat_channelizer::channel_bandwidth, center_freq, conventional);
-  // initialize_prefilter();
-  //  initialize_p25();
 
   modulation_selector = gr::blocks::selector::make(sizeof(gr_complex), 0, 0);
+  qpsk_port = -1;
+  fsk4_port = -1;
+  next_modulation_port = 0;
+  parked_freq = 0;
+  parked_offset = 0;
+  parked_qpsk_mod = true;
+
+  connect(self(), 0, prefilter, 0);
+  connect(prefilter, 0, modulation_selector, 0);
+
+  // Only build the demod + decode chains for the modulations the configured systems use.
+  // If neither is known (no config), fall back to QPSK, which was the default.
+  bool use_qpsk = (config == NULL) || config->qpsk_recorders || !config->fsk4_recorders;
+  bool use_fsk4 = (config != NULL) && config->fsk4_recorders;
+
+  if (use_qpsk) {
+    initialize_qpsk();
+  }
+  if (use_fsk4) {
+    initialize_fsk4();
+  }
+  qpsk_mod = use_qpsk;
+}
+
+void p25_recorder_impl::initialize_qpsk() {
   qpsk_demod = make_p25_recorder_qpsk_demod();
   qpsk_p25_decode = make_p25_recorder_decode(this, silence_frames, d_soft_vocoder);
+  qpsk_port = next_modulation_port++;
+
+  connect(modulation_selector, qpsk_port, qpsk_demod, 0);
+  connect(qpsk_demod, 0, qpsk_p25_decode, 0);
+}
+
+void p25_recorder_impl::initialize_fsk4() {
   fsk4_demod = make_p25_recorder_fsk4_demod();
   fsk4_p25_decode = make_p25_recorder_decode(this, silence_frames, d_soft_vocoder);
+  fsk4_port = next_modulation_port++;
 
-  connect(self(), 0, prefilter, 0);
-  connect(prefilter, 0, modulation_selector, 0);
-  connect(modulation_selector, 0, fsk4_demod, 0);
+  connect(modulation_selector, fsk4_port, fsk4_demod, 0);
   connect(fsk4_demod, 0, fsk4_p25_decode, 0);
-  connect(modulation_selector, 1, qpsk_demod, 0);
-  connect(qpsk_demod, 0, qpsk_p25_decode, 0);
 }
 
 void p25_recorder_impl::switch_tdma(bool phase2) {
@@ -124,10 +151,14 @@ void p25_recorder_impl::clear() {
   //reset_block(fsk4_p25_decode);  // bad - Seg Faults
 
   */
-  qpsk_demod->reset();
-  qpsk_p25_decode->reset();
-  fsk4_demod->reset();
-  fsk4_p25_decode->reset();
+  if (qpsk_port != -1) {
+    qpsk_demod->reset();
+    qpsk_p25_decode->reset();
+  }
+  if (fsk4_port != -1) {
+    fsk4_demod->reset();
+    fsk4_p25_decode->reset();
+  }
 }
 
 void p25_recorder_impl::autotune() {
@@ -254,6 +285,53 @@ void p25_recorder_impl::set_source(long src) {
   }
 }
 
+// Leave an idle recorder tuned to a freq that a grant is expected on, with its
+// selector port open, so the channelizer has settled and the demod has synced
+// by the time start() is called for it. The transmission sink drops what it
+// decodes until then.
+bool p25_recorder_impl::park(double f, bool qpsk) {
+  if (state != INACTIVE) {
+    return false;
+  }
+
+  int port = qpsk ? qpsk_port : fsk4_port;
+  if (port == -1) {
+    return false;
+  }
+
+  int autotune_offset = 0;
+  if (source->get_autotune_source()) {
+    autotune_offset = source->get_source_error();
+  }
+  int offset_amount = (center_freq - f + autotune_offset);
+
+  if ((parked_freq == f) && (parked_offset == offset_amount) && (parked_qpsk_mod == qpsk)) {
+    return true;
+  }
+
+  BOOST_LOG_TRIVIAL(debug) << "p25_recorder.cc: Recorder Num [" << rec_num << "] pre-tuning to " << format_freq(f);
+  prefilter->tune_offset(offset_amount);
+  modulation_selector->set_output_index(port);
+  parked_freq = f;
+  parked_offset = offset_amount;
+  parked_qpsk_mod = qpsk;
+  set_enabled(true);
+  return true;
+}
+
+void p25_recorder_impl::unpark() {
+  if (parked_freq != 0) {
+    parked_freq = 0;
+    if (state == INACTIVE) {
+      set_enabled(false);
+    }
+  }
+}
+
+double p25_recorder_impl::get_parked_freq() {
+  return parked_freq;
+}
+
 std::vector<Transmission> p25_recorder_impl::get_transmission_list() {
   if (qpsk_mod) {
     return qpsk_p25_decode->get_transmission_list();
@@ -286,6 +364,7 @@ void p25_recorder_impl::stop() {
     } else {
       fsk4_p25_decode->stop();
     }
+    source->release_recorder(this);
   } else {
     BOOST_LOG_TRIVIAL(error) << "p25_recorder.cc: Trying to Stop an Inactive Logger!!!";
   }
@@ -304,6 +383,18 @@ bool p25_recorder_impl::start(Call *call) {
   if (state == INACTIVE) {
     System *system = call->get_system();
     qpsk_mod = system->get_qpsk_mod();
+
+    // A chain that was not needed at startup has to be added to the running flowgraph
+    if ((qpsk_mod && (qpsk_port == -1)) || (!qpsk_mod && (fsk4_port == -1))) {
+      BOOST_LOG_TRIVIAL(info) << "p25_recorder.cc: Recorder Num [" << rec_num << "] adding " << (qpsk_mod ? "QPSK" : "FSK4") << " demod chain";
+      lock();
+      if (qpsk_mod) {
+        initialize_qpsk();
+      } else {
+        initialize_fsk4();
+      }
+      unlock();
+    }
     set_tdma(call->get_phase2_tdma());
     if (call->get_phase2_tdma()) {
       if (!qpsk_mod) {
@@ -344,13 +435,18 @@ bool p25_recorder_impl::start(Call *call) {
 
     int offset_amount = (center_freq - chan_freq + autotune_offset);
 
-    prefilter->tune_offset(offset_amount);
+    if ((parked_freq == chan_freq) && (parked_offset == offset_amount) && (parked_qpsk_mod == qpsk_mod)) {
+      BOOST_LOG_TRIVIAL(debug) << loghdr << "Recorder Num [" << rec_num << "] was pre-tuned";
+    } else {
+      prefilter->tune_offset(offset_amount);
+    }
+    parked_freq = 0;
 
     if (qpsk_mod) {
-      modulation_selector->set_output_index(1);
+      modulation_selector->set_output_index(qpsk_port);
       qpsk_p25_decode->start(call);
     } else {
-      modulation_selector->set_output_index(0);
+      modulation_selector->set_output_index(fsk4_port);
       fsk4_p25_decode->start(call);
     }
     state = ACTIVE;
@@ -84,7 +84,6 @@ public:
 
   void initialize_qpsk();
   void initialize_fsk4();
-  void initialize_p25();
   void tune_freq(double f);
   bool start(Call *call);
   void stop();
@@ -96,6 +95,9 @@ public:
   void switch_tdma(bool phase2);
   void set_tdma_slot(int slot);
   void set_source(long src);
+  bool park(double f, bool qpsk_mod);
+  void unpark();
+  double get_parked_freq();
   double since_last_write();
   void process_message_queues();
   double get_current_length();
@@ -126,6 +128,13 @@ protected:
   bool qpsk_mod;
   double squelch_db;
   gr::blocks::selector::sptr modulation_selector;
+  int qpsk_port;
+  int fsk4_port;
+  int next_modulation_port;
+  // freq, offset and modulation an idle recorder is left tuned to, 0 if none
+  double parked_freq;
+  int parked_offset;
+  bool parked_qpsk_mod;
 
   p25_recorder_fsk4_demod_sptr fsk4_demod;
   p25_recorder_decode_sptr fsk4_p25_decode;
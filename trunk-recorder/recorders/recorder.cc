@@ -6,16 +6,25 @@ Recorder::Recorder(Recorder_Type type) {
   this->type = type;
 }
 
+void Recorder::write_stats(Json_Writer &writer) {
+  char id[32];
+  snprintf(id, sizeof(id), "%d_%d", get_source()->get_num(), get_num());
+
+  writer.begin_object();
+  writer.put("id", id);
+  writer.put("type", get_type_string());
+  writer.put("srcNum", get_source()->get_num());
+  writer.put("recNum", get_num());
+  writer.put("count", recording_count);
+  writer.put("duration", recording_duration);
+  writer.put("state", get_state());
+  writer.end_object();
+}
+
 boost::property_tree::ptree Recorder::get_stats() {
-  boost::property_tree::ptree node;
-  node.put("id", boost::lexical_cast<std::string>(get_source()->get_num()) + "_" + boost::lexical_cast<std::string>(get_num()));
-  node.put("type", get_type_string());
-  node.put("srcNum", get_source()->get_num());
-  node.put("recNum", get_num());
-  node.put("count", recording_count);
-  node.put("duration", recording_duration);
-  node.put("state", get_state());
-  return node;
+  Json_Writer writer;
+  write_stats(writer);
+  return writer.to_ptree();
 }
 
 std::string Recorder::get_type_string() {
@@ -87,6 +87,9 @@ public:
   virtual bool start(Call *call) { return false; };
   virtual void stop(){};
   virtual void set_tdma_slot(int slot){};
+  virtual bool park(double f, bool qpsk_mod) { return false; };
+  virtual void unpark(){};
+  virtual double get_parked_freq() { return 0; };
   virtual double get_freq() { return 0; };
   virtual int get_freq_error() { return 0; };
   virtual Source *get_source() { return NULL; };
@@ -106,6 +109,7 @@ public:
   virtual double get_current_length() { return 0; };
   virtual double since_last_write() { return 0; };
   virtual void clear(){};
+  virtual void write_stats(Json_Writer &writer);
   virtual boost::property_tree::ptree get_stats();
   virtual int get_recording_count() { return recording_count; }
   virtual double get_recording_duration() { return recording_duration; }
@@ -1,4 +1,6 @@
 #include "./setup_systems.h"
+#include "./gr_blocks/filter_cache.h"
+#include <algorithm>
 using namespace std;
 bool setup_conventional_channel(System *system, double frequency, long channel_index, Config &config, gr::top_block_sptr &tb, std::vector<Source *> &sources, std::vector<Call *> &calls) {
   bool channel_added = false;
@@ -23,14 +25,14 @@ bool setup_conventional_channel(System *system, double frequency, long channel_i
 
         // If there is a per channel squelch setting, use it, otherwise use the system squelch setting
         if (tg->squelch_db != DB_UNSET) {
-          call = new Call_conventional(tg->number, tg->freq, system, config, tg->squelch_db, tg->signal_detection);
+          call = new Call_conventional(tg->number, tg->freq, system, &config, tg->squelch_db, tg->signal_detection);
         } else {
-          call = new Call_conventional(tg->number, tg->freq, system, config, system->get_squelch_db(), tg->signal_detection);
+          call = new Call_conventional(tg->number, tg->freq, system, &config, system->get_squelch_db(), tg->signal_detection);
         }
         
         call->set_talkgroup_tag(tg->alpha_tag);
       } else {
-        call = new Call_conventional(channel_index, frequency, system, config, system->get_squelch_db(), true);  // signal detection is always true when a channel file is not used
+        call = new Call_conventional(channel_index, frequency, system, &config, system->get_squelch_db(), true);  // signal detection is always true when a channel file is not used
       }
 
       BOOST_LOG_TRIVIAL(info) << "[" << system->get_short_name() << "]\tMonitoring " << system->get_system_type() << " channel: " << format_freq(frequency) << " Talkgroup: " << channel_index;
@@ -121,19 +123,86 @@ bool setup_conventional_system(System *system, Config &config, gr::top_block_spt
   return system_added;
 }
 
+bool setup_control_channel(System *sys, Source *source, double control_channel_freq, gr::top_block_sptr &tb) {
+  System_impl *system = (System_impl *)sys;
+  System_impl::Control_Channel_Slot slot;
+  slot.source = source;
+
+  if (system->get_system_type() == "smartnet") {
+    slot.smartnet_trunking = make_smartnet_trunking(control_channel_freq,
+                                                    source->get_center(),
+                                                    source->get_rate(),
+                                                    system->get_msg_queue(),
+                                                    system->get_sys_num());
+    slot.selector_port = source->create_control_channel_port(tb, slot.smartnet_trunking);
+  } else if (system->get_system_type() == "p25") {
+    slot.p25_trunking = make_p25_trunking(control_channel_freq,
+                                          source->get_center(),
+                                          source->get_rate(),
+                                          system->get_msg_queue(),
+                                          system->get_qpsk_mod(),
+                                          system->get_sys_num());
+    slot.selector_port = source->create_control_channel_port(tb, slot.p25_trunking);
+  } else {
+    return false;
+  }
+
+  BOOST_LOG_TRIVIAL(info) << "[" << system->get_short_name() << "]\tControl Channel decoder on Source " << source->get_num() << " Selector Port: " << slot.selector_port;
+  system->control_channel_slots.push_back(slot);
+  return true;
+}
+
+// Moves the System's control channel decoding to the decoder already built on
+// the given Source. Only selector ports are flipped, so the flow graph keeps
+// running and recorders on every Source are undisturbed.
+bool select_control_channel_source(System *sys, Source *source) {
+  System_impl *system = (System_impl *)sys;
+  System_impl::Control_Channel_Slot *next_slot = system->get_control_channel_slot(source);
+
+  if (next_slot == NULL) {
+    return false;
+  }
+
+  if (system->get_source() != NULL) {
+    System_impl::Control_Channel_Slot *current_slot = system->get_control_channel_slot(system->get_source());
+    if ((current_slot != NULL) && (current_slot != next_slot)) {
+      current_slot->source->set_selector_port_enabled(current_slot->selector_port, false);
+    }
+  }
+
+  system->set_source(source);
+  system->smartnet_trunking = next_slot->smartnet_trunking;
+  system->p25_trunking = next_slot->p25_trunking;
+  source->set_selector_port_enabled(next_slot->selector_port, true);
+  return true;
+}
+
 bool setup_systems(Config &config, gr::top_block_sptr &tb, std::vector<Source *> &sources, std::vector<System *> &systems, std::vector<Call *> &calls) {
 
   Source *source = NULL;
 
-  for (vector<System *>::iterator sys_it = systems.begin(); sys_it != systems.end(); sys_it++) {
+  // Trunked Systems go first, so their control channel decoders get the
+  // lowest selector ports on each Source, ahead of every recorder
+  std::vector<System *> ordered_systems(systems);
+  std::stable_partition(ordered_systems.begin(), ordered_systems.end(), [](System *sys) {
+    return (sys->get_system_type() != "conventional") && (sys->get_system_type() != "conventionalP25") && (sys->get_system_type() != "conventionalDMR");
+  });
+
+  for (vector<System *>::iterator sys_it = ordered_systems.begin(); sys_it != ordered_systems.end(); sys_it++) {
     System_impl *system = (System_impl *)*sys_it;
     // bool    source_found = false;
     bool system_added = false;
     if ((system->get_system_type() == "conventional") || (system->get_system_type() == "conventionalP25") || (system->get_system_type() == "conventionalDMR")) {
       system_added = setup_conventional_system(system, config, tb, sources, calls);
+    } else if (config.recorder_pool_controller != "") {
+      // A Recorder Pool worker is sent its GRANTs and UPDATEs by the controller
+      BOOST_LOG_TRIVIAL(info) << "[" << system->get_short_name() << "]\tControl Channel is decoded by the Recorder Pool controller";
+      system_added = true;
     } else {
       // If it's not a conventional system, then it's a trunking system
       double control_channel_freq = system->get_current_control_channel();
+      std::vector<double> control_channels = system->get_control_channels();
+      Source *control_source = NULL;
       BOOST_LOG_TRIVIAL(info) << "[" << system->get_short_name() << "]\tStarted with Control Channel: " << format_freq(control_channel_freq);
 
       for (vector<Source *>::iterator src_it = sources.begin(); src_it != sources.end(); src_it++) {
@@ -142,36 +211,35 @@ bool setup_systems(Config &config, gr::top_block_sptr &tb, std::vector<Source *>
         if ((source->get_min_hz() <= control_channel_freq) &&
             (source->get_max_hz() >= control_channel_freq)) {
           // The source can cover the System's control channel
-          system_added = true;
-          system->set_source(source);
-
-          if (system->get_system_type() == "smartnet") {
-            system->smartnet_trunking = make_smartnet_trunking(control_channel_freq,
-                                                               source->get_center(),
-                                                               source->get_rate(),
-                                                               system->get_msg_queue(),
-                                                               system->get_sys_num());
-            tb->connect(source->get_src_block(), 0, system->smartnet_trunking, 0);
+          if (setup_control_channel(system, source, control_channel_freq, tb) && (control_source == NULL)) {
+            control_source = source;
           }
+          continue;
+        }
 
-          if (system->get_system_type() == "p25") {
-            system->p25_trunking = make_p25_trunking(control_channel_freq,
-                                                     source->get_center(),
-                                                     source->get_rate(),
-                                                     system->get_msg_queue(),
-                                                     system->get_qpsk_mod(),
-                                                     system->get_sys_num());
-            tb->connect(source->get_src_block(), 0, system->p25_trunking, 0);
+        // Build an idle decoder on any other Source that covers one of the
+        // alternate control channels, so retune_system() can move there
+        // without stopping the flow graph
+        for (vector<double>::iterator cc_it = control_channels.begin(); cc_it != control_channels.end(); cc_it++) {
+          if ((source->get_min_hz() <= *cc_it) && (source->get_max_hz() >= *cc_it)) {
+            setup_control_channel(system, source, *cc_it, tb);
+            break;
           }
-
-          break;
         }
       }
+
+      if (control_source != NULL) {
+        system_added = select_control_channel_source(system, control_source);
+      }
       if (!system_added) {
         BOOST_LOG_TRIVIAL(error) << "[" << system->get_short_name() << "]\t Unable to find a source for this System! Control Channel Freq: " << format_freq(control_channel_freq);
         return false;
       }
     }
   }
+  for (vector<Source *>::iterator src_it = sources.begin(); src_it != sources.end(); src_it++) {
+    (*src_it)->create_recorders(tb);
+  }
+  BOOST_LOG_TRIVIAL(info) << "Filter designs: " << filter_cache::size() << " unique, " << filter_cache::hits() << " reused from cache";
   return true;
 }
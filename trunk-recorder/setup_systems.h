@@ -16,6 +16,8 @@
 
 bool setup_conventional_channel(System *system, double frequency, long channel_index, Config &config, gr::top_block_sptr &tb, std::vector<Source *> &sources, std::vector<Call *> &calls);
 bool setup_conventional_system(System *system, Config &config, gr::top_block_sptr &tb, std::vector<Source *> &sources, std::vector<Call *> &calls);
+bool setup_control_channel(System *system, Source *source, double control_channel_freq, gr::top_block_sptr &tb);
+bool select_control_channel_source(System *system, Source *source);
 bool setup_systems(Config &config, gr::top_block_sptr &tb, std::vector<Source *> &sources, std::vector<System *> &systems, std::vector<Call *> &calls);
 
 #endif
\ No newline at end of file
@@ -1,5 +1,11 @@
 #include "source.h"
 #include "formatter.h"
+#include <algorithm>
+#include <cstring>
+#include <gnuradio/block_detail.h>
+#include <gnuradio/block_registry.h>
+#include <pthread.h>
+#include <sstream>
 
 using json = nlohmann::json;
 
@@ -65,6 +71,9 @@ Source::Source(double c, double r, double e, std::string drv, std::string dev, C
   attached_detector = false;
   attached_selector = false;
   next_selector_port = 0;
+  next_recorder_core_group = 0;
+  realtime_priority = 0;
+  realtime_thread = pthread_t();
   autotune_source = false;
   autotune_manager = new AutotuneManager(this);
 
@@ -171,6 +180,9 @@ void Source::set_iq_source(std::string iq_file, bool repeat, double center, doub
   attached_detector = false;
   attached_selector = false;
   next_selector_port = 0;
+  next_recorder_core_group = 0;
+  realtime_priority = 0;
+  realtime_thread = pthread_t();
   autotune_source = false;
   autotune_manager = new AutotuneManager(this);
 
@@ -215,6 +227,69 @@ Source::Source(std::string iq_file, bool repeat, double center, double rate, Con
   set_iq_source(iq_file, repeat, center, rate);
 }
 
+Source::Source(std::string iq_bus, Config *cfg) {
+  config = cfg;
+  set_iq_bus_source(iq_bus);
+}
+
+// Uses the samples another trunk-recorder publishes from its Source, tuned
+// the same way that Source was
+void Source::set_iq_bus_source(std::string iq_bus) {
+  iq_bus_source::sptr iq_bus_src = iq_bus_source::make(iq_bus);
+  if (!iq_bus_src->is_attached()) {
+    return;
+  }
+
+  rate = iq_bus_src->get_rate();
+  actual_rate = rate;
+  center = iq_bus_src->get_center();
+  error = iq_bus_src->get_error();
+  set_min_max();
+  driver = "iqbus";
+  device = iq_bus;
+  gain = 0;
+  lna_gain = 0;
+  tia_gain = 0;
+  pga_gain = 0;
+  mix_gain = 0;
+  if_gain = 0;
+  src_num = src_counter++;
+  max_digital_recorders = 0;
+  max_debug_recorders = 0;
+  max_sigmf_recorders = 0;
+  max_analog_recorders = 0;
+  debug_recorder_port = 0;
+  attached_detector = false;
+  attached_selector = false;
+  next_selector_port = 0;
+  next_recorder_core_group = 0;
+  realtime_priority = 0;
+  realtime_thread = pthread_t();
+  autotune_source = false;
+  autotune_manager = new AutotuneManager(this);
+
+  recorder_selector = gr::blocks::selector::make(sizeof(gr_complex), 0, 0);
+  signal_detector = signal_detector_cvf::make(rate, 1024, 0, -45, 0.9, true, 0.8, 0.01, 0.0, 50000, "");
+
+  BOOST_LOG_TRIVIAL(info) << "SOURCE TYPE IQ BUS";
+  BOOST_LOG_TRIVIAL(info) << "IQ Bus: " << iq_bus;
+  BOOST_LOG_TRIVIAL(info) << "Center: " << format_freq(center);
+  BOOST_LOG_TRIVIAL(info) << "Error: " << error;
+  BOOST_LOG_TRIVIAL(info) << "Rate: " << FormatSamplingRate(rate);
+
+  source_block = iq_bus_src;
+}
+
+bool Source::publish_iq_bus(gr::top_block_sptr tb, std::string iq_bus) {
+  iq_bus_publisher = iq_bus_sink::make(iq_bus, center, rate, error);
+  if (!iq_bus_publisher->is_publishing()) {
+    return false;
+  }
+  tb->connect(source_block, 0, iq_bus_publisher, 0);
+  place_source_block(iq_bus_publisher);
+  return true;
+}
+
 void Source::set_selector_port_enabled(unsigned int port, bool enabled) {
   recorder_selector->set_port_enabled(port, enabled);
 }
@@ -228,6 +303,120 @@ void Source::attach_selector(gr::top_block_sptr tb) {
     attached_selector = true;
     recorder_selector = gr::blocks::selector::make(sizeof(gr_complex), 0, 0);
     tb->connect(source_block, 0, recorder_selector, 0);
+    place_source_block(recorder_selector);
+  }
+}
+
+static std::string format_cores(const std::vector<int> &cores) {
+  std::stringstream ss;
+  for (size_t i = 0; i < cores.size(); i++) {
+    ss << (i ? "," : "") << cores[i];
+  }
+  return ss.str();
+}
+
+// The blocks that handle every sample from the SDR: the SDR itself, the
+// selector, the signal detector and the IQ Bus publisher
+void Source::place_source_block(gr::basic_block_sptr block) {
+  if (block && !affinity.empty()) {
+    block->set_processor_affinity(affinity);
+  }
+}
+
+// Each recorder and control channel decoder is pinned to the next core group
+// in turn, so its blocks share caches and don't migrate
+void Source::place_recorder(gr::basic_block_sptr block) {
+  if (!recorder_affinity.empty()) {
+    block->set_processor_affinity(recorder_affinity[next_recorder_core_group % recorder_affinity.size()]);
+    next_recorder_core_group++;
+  }
+}
+
+void Source::set_affinity(std::vector<int> cores) {
+  affinity = cores;
+  BOOST_LOG_TRIVIAL(info) << "Source Affinity: " << format_cores(cores);
+  place_source_block(source_block);
+  place_source_block(signal_detector);
+  place_source_block(recorder_selector);
+  place_source_block(iq_bus_publisher);
+}
+
+void Source::set_recorder_affinity(std::vector<std::vector<int>> core_groups) {
+  recorder_affinity = core_groups;
+  for (std::vector<std::vector<int>>::iterator it = core_groups.begin(); it != core_groups.end(); ++it) {
+    BOOST_LOG_TRIVIAL(info) << "Recorder Affinity Group: " << format_cores(*it);
+  }
+}
+
+void Source::set_realtime_priority(int priority) {
+  realtime_priority = priority;
+  if (priority > 0) {
+    BOOST_LOG_TRIVIAL(info) << "Realtime Priority: " << priority;
+  }
+}
+
+// The thread only exists once the flow graph has started, and it is replaced
+// whenever the flow graph is locked and unlocked or stopped and started. It is
+// safe to call this often, it only does anything once the thread has changed.
+void Source::apply_realtime_priority(gr::top_block_sptr tb) {
+  if (realtime_priority <= 0) {
+    return;
+  }
+
+  gr::block_sptr block = realtime_block;
+  if (!block) {
+    block = cast_to_block_sptr(source_block);
+  }
+  if (!block) {
+    // An osmosdr source is a hier block, so the block that talks to the SDR
+    // is found in the flattened flow graph, feeding the first block after it
+    gr::basic_block_sptr next;
+    if (attached_selector) {
+      next = recorder_selector;
+    } else if (attached_detector) {
+      next = signal_detector;
+    } else {
+      next = iq_bus_publisher;
+    }
+
+    if (next) {
+      std::string to = "->" + next->alias() + ":0";
+      std::istringstream lines(tb->edge_list());
+      std::string line;
+      while (std::getline(lines, line)) {
+        if ((line.size() > to.size()) && (line.compare(line.size() - to.size(), to.size(), to) == 0)) {
+          std::string from = line.substr(0, line.size() - to.size());
+          try {
+            block = cast_to_block_sptr(gr::global_block_registry.block_lookup(pmt::intern(from.substr(0, from.rfind(':')))));
+          } catch (std::exception &e) {
+            BOOST_LOG_TRIVIAL(debug) << "Source " << src_num << ": unable to find block " << from << " - " << e.what();
+          }
+          break;
+        }
+      }
+    }
+  }
+
+  if (!block) {
+    BOOST_LOG_TRIVIAL(error) << "Source " << src_num << ": unable to find the SDR block to give realtime priority to";
+    realtime_priority = 0;
+    return;
+  }
+  realtime_block = block;
+
+  // The thread fills in detail()->thread itself once it is running
+  if (!block->detail() || !block->detail()->threaded || pthread_equal(block->detail()->thread, realtime_thread)) {
+    return;
+  }
+  realtime_thread = block->detail()->thread;
+
+  struct sched_param param;
+  param.sched_priority = realtime_priority;
+  int err = pthread_setschedparam(realtime_thread, SCHED_FIFO, &param);
+  if (err != 0) {
+    BOOST_LOG_TRIVIAL(error) << "Source " << src_num << ": unable to set realtime priority " << realtime_priority << " on " << block->alias() << " - " << strerror(err) << ", this needs root, CAP_SYS_NICE or an rtprio limit";
+  } else {
+    BOOST_LOG_TRIVIAL(info) << "Source " << src_num << ": " << block->alias() << " is running at realtime priority " << realtime_priority;
   }
 }
 
@@ -433,35 +622,40 @@ bool Source::get_autotune_source() {
 
 /* -- Recorders -- */
 
-std::vector<Recorder *> Source::find_conventional_recorders_by_freq(Detected_Signal signal) {
-  double freq = center + signal.center_freq;
+// Conventional recorders stay on the frequency they were set up with, so the
+// index only has to be rebuilt when one is added.
+void Source::build_conv_recorder_index() {
+  conv_recorder_index.clear();
 
-  std::vector<Recorder *> recorders;
-  long max_freq_diff = 12500;
   for (std::vector<p25_recorder_sptr>::iterator it = digital_conv_recorders.begin(); it != digital_conv_recorders.end(); it++) {
-    p25_recorder_sptr rx = *it;
-    double recorder_freq = rx->get_freq();
-
-    if (std::abs(freq - recorder_freq) < max_freq_diff) {
-      recorders.push_back((Recorder *)rx.get());
-    }
+    conv_recorder_index.push_back(std::make_pair((*it)->get_freq(), (Recorder *)(*it).get()));
   }
 
   for (std::vector<dmr_recorder_sptr>::iterator it = dmr_conv_recorders.begin(); it != dmr_conv_recorders.end(); it++) {
-    dmr_recorder_sptr rx = *it;
-    double recorder_freq = rx->get_freq();
-
-    if (std::abs(freq - recorder_freq) < max_freq_diff) {
-      recorders.push_back((Recorder *)rx.get());
-    }
+    conv_recorder_index.push_back(std::make_pair((*it)->get_freq(), (Recorder *)(*it).get()));
   }
 
   for (std::vector<analog_recorder_sptr>::iterator it = analog_conv_recorders.begin(); it != analog_conv_recorders.end(); it++) {
-    analog_recorder_sptr rx = *it;
-    double recorder_freq = rx->get_freq();
+    conv_recorder_index.push_back(std::make_pair((*it)->get_freq(), (Recorder *)(*it).get()));
+  }
+
+  std::sort(conv_recorder_index.begin(), conv_recorder_index.end());
+}
+
+std::vector<Recorder *> Source::find_conventional_recorders_by_freq(Detected_Signal signal) {
+  double freq = center + signal.center_freq;
 
-    if (std::abs(freq - recorder_freq) < max_freq_diff) {
-      recorders.push_back((Recorder *)rx.get());
+  std::vector<Recorder *> recorders;
+  long max_freq_diff = 12500;
+
+  if (conv_recorder_index.size() != digital_conv_recorders.size() + dmr_conv_recorders.size() + analog_conv_recorders.size()) {
+    build_conv_recorder_index();
+  }
+
+  std::vector<std::pair<double, Recorder *>>::iterator it = std::lower_bound(conv_recorder_index.begin(), conv_recorder_index.end(), std::make_pair(freq - max_freq_diff, (Recorder *)NULL));
+  for (; (it != conv_recorder_index.end()) && (it->first < freq + max_freq_diff); it++) {
+    if (std::abs(freq - it->first) < max_freq_diff) {
+      recorders.push_back(it->second);
     }
   }
 
@@ -493,6 +687,30 @@ BOOST_LOG_TRIVIAL(info) << " - Setting Signal Detector Threshold to: " << thresh
   signal_detector->set_threshold(threshold);
 }
 
+void Source::set_signal_detector_interval(double interval) {
+  BOOST_LOG_TRIVIAL(info) << " - Setting Signal Detector Interval to: " << interval << "s";
+  signal_detector->set_detection_interval(interval);
+}
+
+void Source::set_signal_detector_segments(int segments) {
+  BOOST_LOG_TRIVIAL(info) << " - Setting Signal Detector Segments to: " << segments;
+  signal_detector->set_segments(segments);
+}
+
+void Source::set_recorder_counts(int digital, int analog, int sigmf) {
+  max_digital_recorders = digital;
+  max_analog_recorders = analog;
+  max_sigmf_recorders = sigmf;
+}
+
+// Called once the control channel decoders have been connected, so they get
+// the lowest selector ports and the recorders follow them
+void Source::create_recorders(gr::top_block_sptr tb) {
+  create_digital_recorders(tb, max_digital_recorders);
+  create_analog_recorders(tb, max_analog_recorders);
+  create_sigmf_recorders(tb, max_sigmf_recorders);
+}
+
 void Source::create_analog_recorders(gr::top_block_sptr tb, int r) {
   if (r > 0) {
     attach_selector(tb);
@@ -504,8 +722,14 @@ void Source::create_analog_recorders(gr::top_block_sptr tb, int r) {
     analog_recorders.push_back(log);
     log->set_selector_port(next_selector_port);
     tb->connect(recorder_selector, next_selector_port, log, 0);
+    place_recorder(log);
     next_selector_port++;
   }
+
+  // the list is taken from the back, so the lowest numbered recorders go first
+  for (std::vector<analog_recorder_sptr>::reverse_iterator it = analog_recorders.rbegin(); it != analog_recorders.rend(); it++) {
+    available_analog_recorders.push_back((Recorder *)it->get());
+  }
 }
 
 void Source::create_digital_recorders(gr::top_block_sptr tb, int r) {
@@ -520,8 +744,26 @@ void Source::create_digital_recorders(gr::top_block_sptr tb, int r) {
     digital_recorders.push_back(log);
     log->set_selector_port(next_selector_port);
     tb->connect(recorder_selector, next_selector_port, log, 0);
+    place_recorder(log);
     next_selector_port++;
   }
+
+  // the list is taken from the back, so the lowest numbered recorders go first
+  for (std::vector<p25_recorder_sptr>::reverse_iterator it = digital_recorders.rbegin(); it != digital_recorders.rend(); it++) {
+    available_digital_recorders.push_back((Recorder *)it->get());
+  }
+}
+
+// Control channel decoders hang off the selector like recorders do, starting
+// disabled, so a System can switch which Source feeds its decoder without
+// stopping the flow graph.
+int Source::create_control_channel_port(gr::top_block_sptr tb, gr::basic_block_sptr control_channel) {
+  attach_selector(tb);
+  int port = next_selector_port;
+  tb->connect(recorder_selector, port, control_channel, 0);
+  place_recorder(control_channel);
+  next_selector_port++;
+  return port;
 }
 
 void Source::create_sigmf_recorders(gr::top_block_sptr tb, int r) {
@@ -536,6 +778,8 @@ void Source::create_sigmf_recorders(gr::top_block_sptr tb, int r) {
     sigmf_recorders.push_back(log);
     log->set_selector_port(next_selector_port);
     tb->connect(recorder_selector, next_selector_port, log, 0);
+    place_recorder(log);
+    next_selector_port++;
   }
 }
 
@@ -549,6 +793,7 @@ analog_recorder_sptr Source::create_conventional_recorder(gr::top_block_sptr tb,
   analog_conv_recorders.push_back(log);
   log->set_selector_port(next_selector_port);
   tb->connect(recorder_selector, next_selector_port, log, 0);
+  place_recorder(log);
   next_selector_port++;
   return log;
 }
@@ -563,6 +808,7 @@ analog_recorder_sptr Source::create_conventional_recorder(gr::top_block_sptr tb)
   analog_conv_recorders.push_back(log);
   log->set_selector_port(next_selector_port);
   tb->connect(recorder_selector, next_selector_port, log, 0);
+  place_recorder(log);
   next_selector_port++;
   return log;
 }
@@ -575,6 +821,7 @@ sigmf_recorder_sptr Source::create_sigmf_conventional_recorder(gr::top_block_spt
   sigmf_conv_recorders.push_back(log);
   log->set_selector_port(next_selector_port);
   tb->connect(recorder_selector, next_selector_port, log, 0);
+  place_recorder(log);
   next_selector_port++;
   return log;
 }
@@ -589,6 +836,7 @@ p25_recorder_sptr Source::create_digital_conventional_recorder(gr::top_block_spt
   digital_conv_recorders.push_back(log);
   log->set_selector_port(next_selector_port);
   tb->connect(recorder_selector, next_selector_port, log, 0);
+  place_recorder(log);
   next_selector_port++;
   return log;
 }
@@ -603,6 +851,7 @@ dmr_recorder_sptr Source::create_dmr_conventional_recorder(gr::top_block_sptr tb
   dmr_conv_recorders.push_back(log);
   log->set_selector_port(next_selector_port);
   tb->connect(recorder_selector, next_selector_port, log, 0);
+  place_recorder(log);
   next_selector_port++;
   return log;
 }
@@ -613,6 +862,7 @@ void Source::create_debug_recorder(gr::top_block_sptr tb, int source_num) {
   debug_recorder_sptr log = make_debug_recorder(this, config->debug_recorder_address, debug_recorder_port);
   debug_recorders.push_back(log);
   tb->connect(source_block, 0, log, 0);
+  place_recorder(log);
 }
 
 Recorder *Source::get_analog_recorder(Talkgroup *talkgroup, int priority, Call *call) {
@@ -636,14 +886,12 @@ Recorder *Source::get_analog_recorder(Talkgroup *talkgroup, int priority, Call *
 }
 
 Recorder *Source::get_analog_recorder(Call *call) {
-  for (std::vector<analog_recorder_sptr>::iterator it = analog_recorders.begin();
-       it != analog_recorders.end(); it++) {
-    analog_recorder_sptr rx = *it;
+  while (!available_analog_recorders.empty()) {
+    Recorder *rx = available_analog_recorders.back();
+    available_analog_recorders.pop_back();
 
     if (rx->get_state() == AVAILABLE) {
-      return (Recorder *)rx.get();
-
-      break;
+      return rx;
     }
   }
   std::string loghdr = log_header( call->get_short_name(), call->get_call_num(), call->get_talkgroup_display(), call->get_freq());
@@ -673,14 +921,21 @@ Recorder *Source::get_digital_recorder(Talkgroup *talkgroup, int priority, Call
 }
 
 Recorder *Source::get_digital_recorder(Call *call) {
-  for (std::vector<p25_recorder_sptr>::iterator it = digital_recorders.begin();
-       it != digital_recorders.end(); it++) {
-    p25_recorder_sptr rx = *it;
+  // A recorder that is already tuned to the call's freq skips the retune and resync
+  for (std::vector<Recorder *>::iterator it = available_digital_recorders.begin(); it != available_digital_recorders.end(); it++) {
+    Recorder *rx = *it;
+    if ((rx->get_parked_freq() == call->get_freq()) && (rx->get_state() == AVAILABLE)) {
+      available_digital_recorders.erase(it);
+      return rx;
+    }
+  }
 
-    if (rx->get_state() == AVAILABLE) {
-      return (Recorder *)rx.get();
+  while (!available_digital_recorders.empty()) {
+    Recorder *rx = available_digital_recorders.back();
+    available_digital_recorders.pop_back();
 
-      break;
+    if (rx->get_state() == AVAILABLE) {
+      return rx;
     }
   }
   std::string loghdr = log_header( call->get_short_name(), call->get_call_num(), call->get_talkgroup_display(), call->get_freq());
@@ -788,30 +1043,85 @@ int Source::sigmf_recorder_count() {
 }
 
 int Source::get_num_available_digital_recorders() {
-  int num_available_recorders = 0;
+  return available_digital_recorders.size();
+}
 
-  for (std::vector<p25_recorder_sptr>::iterator it = digital_recorders.begin();
-       it != digital_recorders.end(); it++) {
+int Source::get_num_available_analog_recorders() {
+  return available_analog_recorders.size();
+}
+
+// Called when a trunk recorder stops, or when one that was handed out could
+// not be started. Conventional recorders are dedicated to a channel and are
+// never pooled.
+void Source::release_recorder(Recorder *recorder) {
+  std::vector<Recorder *> *available;
+
+  switch (recorder->get_type()) {
+  case P25:
+    available = &available_digital_recorders;
+    break;
+  case ANALOG:
+    available = &available_analog_recorders;
+    break;
+  default:
+    return;
+  }
+
+  if (std::find(available->begin(), available->end(), recorder) == available->end()) {
+    available->push_back(recorder);
+  }
+}
+
+// Keeps one idle digital recorder tuned to each of freqs that this Source
+// covers and that isn't already being recorded. Recorders are taken from the
+// front of the free list, which is the end that is handed out last.
+void Source::pretune_digital_recorders(std::vector<Pretune_Freq> freqs) {
+  for (std::vector<p25_recorder_sptr>::iterator it = digital_recorders.begin(); it != digital_recorders.end(); it++) {
     p25_recorder_sptr rx = *it;
+    double parked_freq = rx->get_parked_freq();
+    if (parked_freq == 0) {
+      continue;
+    }
 
-    if (rx->get_state() == AVAILABLE) {
-      num_available_recorders++;
+    bool wanted = false;
+    for (std::vector<Pretune_Freq>::iterator f = freqs.begin(); f != freqs.end(); f++) {
+      if (f->freq == parked_freq) {
+        wanted = true;
+        break;
+      }
+    }
+    if (!wanted) {
+      rx->unpark();
     }
   }
-  return num_available_recorders;
-}
 
-int Source::get_num_available_analog_recorders() {
-  int num_available_recorders = 0;
+  std::vector<Recorder *>::iterator next = available_digital_recorders.begin();
+  for (std::vector<Pretune_Freq>::iterator f = freqs.begin(); f != freqs.end(); f++) {
+    if ((f->freq < min_hz) || (f->freq > max_hz)) {
+      continue;
+    }
 
-  for (std::vector<analog_recorder_sptr>::iterator it = analog_recorders.begin(); it != analog_recorders.end(); it++) {
-    analog_recorder_sptr rx = *it;
+    bool covered = false;
+    for (std::vector<p25_recorder_sptr>::iterator it = digital_recorders.begin(); it != digital_recorders.end(); it++) {
+      p25_recorder_sptr rx = *it;
+      if ((rx->get_parked_freq() == f->freq) || (rx->is_active() && (rx->get_freq() == f->freq))) {
+        covered = true;
+        break;
+      }
+    }
+    if (covered) {
+      continue;
+    }
 
-    if (rx->get_state() == AVAILABLE) {
-      num_available_recorders++;
+    while ((next != available_digital_recorders.end()) && (((*next)->get_parked_freq() != 0) || ((*next)->get_state() != AVAILABLE))) {
+      next++;
+    }
+    if (next == available_digital_recorders.end()) {
+      return;
     }
+    (*next)->park(f->freq, f->qpsk_mod);
+    next++;
   }
-  return num_available_recorders;
 }
 
 std::vector<Recorder *> Source::get_recorders() {
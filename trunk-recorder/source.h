@@ -9,6 +9,8 @@
 #include "recorders/dmr_recorder.h"
 #include "recorders/p25_recorder.h"
 #include "recorders/sigmf_recorder.h"
+#include "sources/iq_bus_sink.h"
+#include "sources/iq_bus_source.h"
 #include "sources/iq_file_source.h"
 #include <gnuradio/basic_block.h>
 #include <gnuradio/top_block.h>
@@ -16,6 +18,7 @@
 #include <iostream>
 #include <numeric>
 #include <osmosdr/source.h>
+#include <pthread.h>
 
 #include <json.hpp>
 
@@ -52,6 +55,15 @@ class Source {
   int max_analog_recorders;
   int debug_recorder_port;
   int next_selector_port;
+  // cores for the blocks that handle every sample, and the core groups the
+  // recorders are spread over
+  std::vector<int> affinity;
+  std::vector<std::vector<int>> recorder_affinity;
+  unsigned int next_recorder_core_group;
+  int realtime_priority;
+  // the SDR block, once found, and the thread it was last given priority on
+  gr::block_sptr realtime_block;
+  pthread_t realtime_thread;
   int silence_frames;
   Config *config;
   bool autotune_source;
@@ -64,15 +76,25 @@ class Source {
   std::vector<analog_recorder_sptr> analog_recorders;
   std::vector<analog_recorder_sptr> analog_conv_recorders;
   std::vector<dmr_recorder_sptr> dmr_conv_recorders;
+  // trunk recorders that are AVAILABLE, so a grant can take one without
+  // scanning. Recorders leave when handed out and come back in release_recorder()
+  std::vector<Recorder *> available_digital_recorders;
+  std::vector<Recorder *> available_analog_recorders;
+  // conventional recorders sorted by frequency, for matching detected signals
+  std::vector<std::pair<double, Recorder *>> conv_recorder_index;
   std::vector<Gain_Stage_t> gain_stages;
   std::string driver;
   std::string device;
   std::string antenna;
   gr::basic_block_sptr source_block;
+  iq_bus_sink::sptr iq_bus_publisher;
   gr::blocks::selector::sptr recorder_selector;
   signal_detector_cvf::sptr signal_detector;
 
   void add_gain_stage(std::string stage_name, double value);
+  void place_source_block(gr::basic_block_sptr block);
+  void place_recorder(gr::basic_block_sptr block);
+  void build_conv_recorder_index();
 
 public:
   int get_num();
@@ -80,7 +102,10 @@ public:
   Source(double c, double r, double e, std::string driver, std::string device, Config *cfg);
   Source(std::string sigmf_meta, std::string sigmf_data, bool repeat, Config *cfg);
   Source(std::string iq_file, bool repeat, double center, double rate, Config *cfg);
+  Source(std::string iq_bus, Config *cfg);
   void set_iq_source(std::string iq_file, bool repeat, double center, double rate);
+  void set_iq_bus_source(std::string iq_bus);
+  bool publish_iq_bus(gr::top_block_sptr tb, std::string iq_bus);
   gr::basic_block_sptr get_src_block();
   void attach_detector(gr::top_block_sptr tb);
   void attach_selector(gr::top_block_sptr tb);
@@ -130,15 +155,27 @@ public:
   int analog_recorder_count();
   int get_num_available_analog_recorders();
   int get_num_available_digital_recorders();
+  void release_recorder(Recorder *recorder);
+  void pretune_digital_recorders(std::vector<Pretune_Freq> freqs);
   void set_signal_detector_threshold(float t);
+  void set_signal_detector_interval(double interval);
+  void set_signal_detector_segments(int segments);
   std::vector<Recorder *> find_conventional_recorders_by_freq(Detected_Signal ds);
   void enable_detected_recorders();
   void set_selector_port_enabled(unsigned int port, bool enabled);
   bool is_selector_port_enabled(unsigned int port);
+  gr::basic_block_sptr get_recorder_selector() { return recorder_selector; }
+  void set_affinity(std::vector<int> cores);
+  void set_recorder_affinity(std::vector<std::vector<int>> core_groups);
+  void set_realtime_priority(int priority);
+  void apply_realtime_priority(gr::top_block_sptr tb);
   void create_debug_recorder(gr::top_block_sptr tb, int source_num);
+  void set_recorder_counts(int digital, int analog, int sigmf);
+  void create_recorders(gr::top_block_sptr tb);
   void create_sigmf_recorders(gr::top_block_sptr tb, int r);
   void create_analog_recorders(gr::top_block_sptr tb, int r);
   void create_digital_recorders(gr::top_block_sptr tb, int r);
+  int create_control_channel_port(gr::top_block_sptr tb, gr::basic_block_sptr control_channel);
 
   analog_recorder_sptr create_conventional_recorder(gr::top_block_sptr tb);
   analog_recorder_sptr create_conventional_recorder(gr::top_block_sptr tb, float tone_freq);
@@ -167,6 +204,9 @@ public:
   inline gr::uhd::usrp_source::sptr cast_to_usrp_sptr(gr::basic_block_sptr p) {
     return boost::dynamic_pointer_cast<gr::uhd::usrp_source, gr::basic_block>(p);
   }
+  inline gr::block_sptr cast_to_block_sptr(gr::basic_block_sptr p) {
+    return boost::dynamic_pointer_cast<gr::block, gr::basic_block>(p);
+  }
 #else
   inline osmosdr::source::sptr cast_to_osmo_sptr(gr::basic_block_sptr p) {
     return std::dynamic_pointer_cast<osmosdr::source, gr::basic_block>(p);
@@ -174,6 +214,9 @@ public:
   inline gr::uhd::usrp_source::sptr cast_to_usrp_sptr(gr::basic_block_sptr p) {
     return std::dynamic_pointer_cast<gr::uhd::usrp_source, gr::basic_block>(p);
   }
+  inline gr::block_sptr cast_to_block_sptr(gr::basic_block_sptr p) {
+    return std::dynamic_pointer_cast<gr::block, gr::basic_block>(p);
+  }
 #endif
 };
 #endif
@@ -0,0 +1,273 @@
+#include "iq_bus.h"
+
+#include <algorithm>
+#include <boost/log/trivial.hpp>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char IQ_BUS_MAGIC[4] = {'T', 'R', 'I', 'Q'};
+static const uint32_t IQ_BUS_VERSION = 1;
+static const uint64_t STAMP_UNSET = UINT64_MAX;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "the IQ bus needs lock free 64 bit atomics");
+
+static std::string iq_bus_shm_name(std::string name) {
+  return "/trunk-recorder-iq-" + name;
+}
+
+// The samples start on a cache line after the header
+static size_t iq_bus_ring_offset() {
+  return (sizeof(Iq_Bus_Header) + 63) & ~(size_t)63;
+}
+
+static void copy_from_ring(const std::complex<float> *ring, uint64_t capacity, uint64_t position, std::complex<float> *out, size_t count) {
+  size_t start = position & (capacity - 1);
+  size_t first = std::min((size_t)(capacity - start), count);
+  memcpy(out, ring + start, first * sizeof(std::complex<float>));
+  memcpy(out + first, ring, (count - first) * sizeof(std::complex<float>));
+}
+
+Iq_Bus_Writer::Iq_Bus_Writer() {
+  header = NULL;
+  ring = NULL;
+  mapped_size = 0;
+  position = 0;
+}
+
+Iq_Bus_Writer::~Iq_Bus_Writer() {
+  close();
+}
+
+bool Iq_Bus_Writer::create(std::string name, double center, double rate, double error, uint64_t capacity) {
+  uint64_t rounded = 1;
+  while (rounded < capacity) {
+    rounded <<= 1;
+  }
+  capacity = rounded;
+
+  shm_name = iq_bus_shm_name(name);
+  mapped_size = iq_bus_ring_offset() + capacity * sizeof(std::complex<float>);
+
+  // Readers still mapping an old bus keep it until they notice the new one
+  shm_unlink(shm_name.c_str());
+  int fd = shm_open(shm_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+  if (fd < 0) {
+    BOOST_LOG_TRIVIAL(error) << "IQ Bus " << name << ": unable to create shared memory - " << strerror(errno);
+    return false;
+  }
+  // Allocated up front, since tmpfs only reserves pages as they are written
+  // and running out part way through would kill the publisher with SIGBUS
+  int err = posix_fallocate(fd, 0, mapped_size);
+  if (err != 0) {
+    BOOST_LOG_TRIVIAL(error) << "IQ Bus " << name << ": unable to allocate " << (mapped_size + (1 << 20) - 1) / (1 << 20) << " MB of shared memory in /dev/shm - " << strerror(err);
+    ::close(fd);
+    shm_unlink(shm_name.c_str());
+    return false;
+  }
+  void *mem = mmap(NULL, mapped_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (mem == MAP_FAILED) {
+    BOOST_LOG_TRIVIAL(error) << "IQ Bus " << name << ": unable to map shared memory - " << strerror(errno);
+    shm_unlink(shm_name.c_str());
+    return false;
+  }
+
+  header = new (mem) Iq_Bus_Header();
+  ring = (std::complex<float> *)((char *)mem + iq_bus_ring_offset());
+  header->version = IQ_BUS_VERSION;
+  header->session = std::chrono::system_clock::now().time_since_epoch().count() ^ ((uint64_t)getpid() << 32);
+  header->center = center;
+  header->rate = rate;
+  header->error = error;
+  header->capacity = capacity;
+  header->claim_pos.store(0, std::memory_order_relaxed);
+  header->write_pos.store(0, std::memory_order_relaxed);
+  header->stamp_count.store(0, std::memory_order_relaxed);
+  for (int i = 0; i < IQ_BUS_STAMPS; i++) {
+    header->stamps[i].sample.store(STAMP_UNSET, std::memory_order_relaxed);
+  }
+  position = 0;
+
+  // Readers check the magic last, so they never see a half built header
+  std::atomic_thread_fence(std::memory_order_release);
+  memcpy(header->magic, IQ_BUS_MAGIC, sizeof(IQ_BUS_MAGIC));
+  return true;
+}
+
+void Iq_Bus_Writer::write(const std::complex<float> *samples, size_t count, int64_t time_ns) {
+  uint64_t capacity = header->capacity;
+
+  // Only the newest ring full of a large block could ever be read
+  if (count > capacity) {
+    time_ns += (int64_t)((count - capacity) * 1e9 / header->rate);
+    samples += count - capacity;
+    count = capacity;
+  }
+
+  header->claim_pos.store(position + count, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  size_t start = position & (capacity - 1);
+  size_t first = std::min((size_t)(capacity - start), count);
+  memcpy(ring + start, samples, first * sizeof(std::complex<float>));
+  memcpy(ring, samples + first, (count - first) * sizeof(std::complex<float>));
+
+  uint64_t stamp_count = header->stamp_count.load(std::memory_order_relaxed);
+  Iq_Bus_Stamp &stamp = header->stamps[stamp_count % IQ_BUS_STAMPS];
+  stamp.sample.store(STAMP_UNSET, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  stamp.time_ns.store(time_ns, std::memory_order_relaxed);
+  stamp.sample.store(position, std::memory_order_release);
+  header->stamp_count.store(stamp_count + 1, std::memory_order_release);
+
+  position += count;
+  header->write_pos.store(position, std::memory_order_release);
+}
+
+void Iq_Bus_Writer::close() {
+  if (header) {
+    munmap(header, mapped_size);
+    shm_unlink(shm_name.c_str());
+    header = NULL;
+    ring = NULL;
+  }
+}
+
+Iq_Bus_Reader::Iq_Bus_Reader() {
+  header = NULL;
+  ring = NULL;
+  mapped_size = 0;
+  position = 0;
+}
+
+Iq_Bus_Reader::~Iq_Bus_Reader() {
+  close();
+}
+
+bool Iq_Bus_Reader::open(std::string name) {
+  close();
+  shm_name = iq_bus_shm_name(name);
+
+  int fd = shm_open(shm_name.c_str(), O_RDONLY, 0);
+  if (fd < 0) {
+    return false;
+  }
+
+  struct stat st;
+  if ((fstat(fd, &st) != 0) || ((size_t)st.st_size < iq_bus_ring_offset())) {
+    ::close(fd);
+    return false;
+  }
+  void *mem = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (mem == MAP_FAILED) {
+    return false;
+  }
+
+  Iq_Bus_Header *bus = (Iq_Bus_Header *)mem;
+  bool valid = (memcmp(bus->magic, IQ_BUS_MAGIC, sizeof(IQ_BUS_MAGIC)) == 0);
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (!valid || (bus->version != IQ_BUS_VERSION) || ((size_t)st.st_size < iq_bus_ring_offset() + bus->capacity * sizeof(std::complex<float>))) {
+    munmap(mem, st.st_size);
+    return false;
+  }
+
+  header = bus;
+  ring = (std::complex<float> *)((char *)mem + iq_bus_ring_offset());
+  mapped_size = st.st_size;
+  position = header->write_pos.load(std::memory_order_acquire);
+  return true;
+}
+
+void Iq_Bus_Reader::close() {
+  if (header) {
+    munmap(header, mapped_size);
+    header = NULL;
+    ring = NULL;
+  }
+}
+
+size_t Iq_Bus_Reader::read(std::complex<float> *out, size_t count, uint64_t &dropped) {
+  uint64_t capacity = header->capacity;
+  uint64_t write_pos = header->write_pos.load(std::memory_order_acquire);
+  dropped = 0;
+
+  if (write_pos - position > capacity) {
+    dropped = write_pos - position;
+    position = write_pos;
+    return 0;
+  }
+
+  size_t n = std::min((uint64_t)count, write_pos - position);
+  if (n == 0) {
+    return 0;
+  }
+  copy_from_ring(ring, capacity, position, out, n);
+
+  // Anything the writer started overwriting while it was being copied is
+  // thrown away
+  std::atomic_thread_fence(std::memory_order_acquire);
+  uint64_t claim_pos = header->claim_pos.load(std::memory_order_relaxed);
+  size_t lost = 0;
+  if (claim_pos > position + capacity) {
+    lost = std::min((uint64_t)n, claim_pos - capacity - position);
+    memmove(out, out + lost, (n - lost) * sizeof(std::complex<float>));
+    dropped = lost;
+  }
+
+  position += n;
+  return n - lost;
+}
+
+bool Iq_Bus_Reader::find_stamp(uint64_t from, uint64_t to, uint64_t &sample, int64_t &time_ns) const {
+  uint64_t stamp_count = header->stamp_count.load(std::memory_order_acquire);
+
+  for (uint64_t i = stamp_count; (i > 0) && (i + IQ_BUS_STAMPS > stamp_count); i--) {
+    const Iq_Bus_Stamp &stamp = header->stamps[(i - 1) % IQ_BUS_STAMPS];
+    uint64_t first = stamp.sample.load(std::memory_order_acquire);
+    int64_t time = stamp.time_ns.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if ((first == STAMP_UNSET) || (stamp.sample.load(std::memory_order_relaxed) != first)) {
+      continue;
+    }
+    if (first < from) {
+      return false;
+    }
+    if (first < to) {
+      sample = first;
+      time_ns = time;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool Iq_Bus_Reader::writer_restarted() const {
+  int fd = shm_open(shm_name.c_str(), O_RDONLY, 0);
+  if (fd < 0) {
+    return false;
+  }
+
+  // A writer that is still sizing the bus has not come back yet
+  struct stat st;
+  if ((fstat(fd, &st) != 0) || ((size_t)st.st_size < sizeof(Iq_Bus_Header))) {
+    ::close(fd);
+    return false;
+  }
+
+  bool restarted = false;
+  void *mem = mmap(NULL, sizeof(Iq_Bus_Header), PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (mem != MAP_FAILED) {
+    const Iq_Bus_Header *bus = (const Iq_Bus_Header *)mem;
+    restarted = (memcmp(bus->magic, IQ_BUS_MAGIC, sizeof(IQ_BUS_MAGIC)) == 0) && (bus->session != header->session);
+    munmap(mem, sizeof(Iq_Bus_Header));
+  }
+  return restarted;
+}
@@ -0,0 +1,104 @@
+#ifndef IQ_BUS_H
+#define IQ_BUS_H
+
+#include <atomic>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/*
+ * A shared memory ring of IQ samples, so that one trunk-recorder process can
+ * publish the samples from a Source and other trunk-recorder processes can
+ * use them as their own Source.
+ *
+ * The bus lives in POSIX shared memory, /dev/shm/trunk-recorder-iq-<name>.
+ * There is one writer and any number of readers. The writer never waits:
+ * a reader that falls more than a ring behind skips ahead to the newest
+ * samples and is told how many it missed. The writer also records the wall
+ * clock time of the first sample of each block it writes, so readers can
+ * tell when a sample was received.
+ */
+
+static const int IQ_BUS_STAMPS = 256;
+
+struct Iq_Bus_Stamp {
+  std::atomic<uint64_t> sample;
+  std::atomic<int64_t> time_ns;
+};
+
+struct Iq_Bus_Header {
+  char magic[4];
+  uint32_t version;
+  // Different every time a writer creates the bus, so readers can tell that
+  // the process on the other end was restarted
+  uint64_t session;
+  double center;
+  double rate;
+  double error;
+  uint64_t capacity; // in samples, a power of two
+
+  // Samples ever started and finished by the writer. A slot can only be
+  // trusted by a reader once it is below write_pos and the writer has not
+  // claimed it again, that is claim_pos has not moved a whole ring past it.
+  std::atomic<uint64_t> claim_pos;
+  std::atomic<uint64_t> write_pos;
+  std::atomic<uint64_t> stamp_count;
+  Iq_Bus_Stamp stamps[IQ_BUS_STAMPS];
+};
+
+class Iq_Bus_Writer {
+public:
+  Iq_Bus_Writer();
+  ~Iq_Bus_Writer();
+
+  // Creates the bus, replacing any bus left behind under the same name. The
+  // capacity is rounded up to a power of two.
+  bool create(std::string name, double center, double rate, double error, uint64_t capacity);
+  void write(const std::complex<float> *samples, size_t count, int64_t time_ns);
+  void close();
+
+private:
+  std::string shm_name;
+  Iq_Bus_Header *header;
+  std::complex<float> *ring;
+  size_t mapped_size;
+  uint64_t position;
+};
+
+class Iq_Bus_Reader {
+public:
+  Iq_Bus_Reader();
+  ~Iq_Bus_Reader();
+
+  // Attaches to the bus, starting at its newest sample
+  bool open(std::string name);
+  void close();
+  bool is_open() const { return header != NULL; }
+
+  // Copies up to count samples into out and returns how many. dropped is
+  // set to the number of samples that were overwritten before they could
+  // be read, which are skipped.
+  size_t read(std::complex<float> *out, size_t count, uint64_t &dropped);
+
+  // The latest time stamp for a sample in [from, to), if there is one
+  bool find_stamp(uint64_t from, uint64_t to, uint64_t &sample, int64_t &time_ns) const;
+
+  // True once the writer has gone away and come back, so the bus has to be
+  // opened again to see its samples
+  bool writer_restarted() const;
+
+  uint64_t get_position() const { return position; }
+  double get_center() const { return header->center; }
+  double get_rate() const { return header->rate; }
+  double get_error() const { return header->error; }
+
+private:
+  std::string shm_name;
+  Iq_Bus_Header *header;
+  std::complex<float> *ring;
+  size_t mapped_size;
+  uint64_t position;
+};
+
+#endif
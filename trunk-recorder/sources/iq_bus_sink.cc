@@ -0,0 +1,36 @@
+#include "iq_bus_sink.h"
+#include <boost/log/trivial.hpp>
+#include <chrono>
+
+iq_bus_sink::sptr
+iq_bus_sink::make(std::string name, double center, double rate, double error) {
+  return gnuradio::get_initial_sptr(new iq_bus_sink(name, center, rate, error));
+}
+
+iq_bus_sink::iq_bus_sink(std::string name, double center, double rate, double error)
+    : gr::sync_block("iq_bus_sink",
+                     gr::io_signature::make(1, 1, sizeof(gr_complex)),
+                     gr::io_signature::make(0, 0, 0)),
+      d_name(name),
+      d_rate(rate) {
+
+  // About a second of samples, so a reader can fall that far behind before
+  // it starts to lose samples
+  d_publishing = d_writer.create(name, center, rate, error, (uint64_t)rate);
+  if (d_publishing) {
+    BOOST_LOG_TRIVIAL(info) << "IQ Bus " << name << ": publishing";
+  }
+}
+
+int iq_bus_sink::work(int noutput_items, gr_vector_const_void_star &input_items, gr_vector_void_star &output_items) {
+  const gr_complex *in = (const gr_complex *)input_items[0];
+
+  if (d_publishing) {
+    // The block has just arrived, so its first sample was received one block
+    // length ago
+    int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    d_writer.write(in, noutput_items, now - (int64_t)(noutput_items * 1e9 / d_rate));
+  }
+
+  return noutput_items;
+}
@@ -0,0 +1,31 @@
+#ifndef IQ_BUS_SINK_H
+#define IQ_BUS_SINK_H
+
+#include "iq_bus.h"
+#include <gnuradio/io_signature.h>
+#include <gnuradio/sync_block.h>
+
+// Publishes the samples from a Source on an IQ Bus
+class iq_bus_sink : public gr::sync_block {
+private:
+  std::string d_name;
+  double d_rate;
+  bool d_publishing;
+  Iq_Bus_Writer d_writer;
+
+public:
+#if GNURADIO_VERSION < 0x030900
+  typedef boost::shared_ptr<iq_bus_sink> sptr;
+#else
+  typedef std::shared_ptr<iq_bus_sink> sptr;
+#endif
+  static sptr make(std::string name, double center, double rate, double error);
+
+  iq_bus_sink(std::string name, double center, double rate, double error);
+
+  bool is_publishing() const { return d_publishing; }
+
+  int work(int noutput_items, gr_vector_const_void_star &input_items, gr_vector_void_star &output_items);
+};
+
+#endif
@@ -0,0 +1,112 @@
+#include "iq_bus_source.h"
+#include "../metrics.h"
+#include <boost/log/trivial.hpp>
+#include <pmt/pmt.h>
+#include <thread>
+
+iq_bus_source::sptr
+iq_bus_source::make(std::string name) {
+  return gnuradio::get_initial_sptr(new iq_bus_source(name));
+}
+
+iq_bus_source::iq_bus_source(std::string name)
+    : gr::sync_block("iq_bus_source",
+                     gr::io_signature::make(0, 0, 0),
+                     gr::io_signature::make(1, 1, sizeof(gr_complex))),
+      d_name(name),
+      d_tag_next(true),
+      d_dropped(0) {
+
+  d_last_sample = std::chrono::steady_clock::now();
+  d_last_check = d_last_sample;
+  d_last_dropped_report = d_last_sample;
+
+  if (!d_reader.open(name)) {
+    BOOST_LOG_TRIVIAL(error) << "IQ Bus " << name << ": nothing is publishing it";
+  }
+}
+
+// When the publishing process is restarted it creates a new bus, and the
+// one that is still mapped here will never see another sample
+void iq_bus_source::reattach_if_restarted() {
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  if ((now - d_last_sample < std::chrono::seconds(1)) || (now - d_last_check < std::chrono::seconds(1))) {
+    return;
+  }
+  d_last_check = now;
+
+  if (!d_reader.writer_restarted()) {
+    return;
+  }
+
+  double center = d_reader.get_center();
+  double rate = d_reader.get_rate();
+  if (!d_reader.open(d_name)) {
+    return;
+  }
+  if ((d_reader.get_center() != center) || (d_reader.get_rate() != rate)) {
+    BOOST_LOG_TRIVIAL(error) << "IQ Bus " << d_name << ": the publisher came back with a different center or rate, restart to pick them up";
+  } else {
+    BOOST_LOG_TRIVIAL(info) << "IQ Bus " << d_name << ": publisher restarted, reattached";
+  }
+  d_tag_next = true;
+}
+
+void iq_bus_source::report_dropped(uint64_t dropped) {
+  d_dropped += dropped;
+  Metrics::overrun_samples += dropped;
+  d_tag_next = true;
+
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  if (now - d_last_dropped_report >= std::chrono::seconds(10)) {
+    BOOST_LOG_TRIVIAL(error) << "IQ Bus " << d_name << ": overrun, dropped " << d_dropped << " samples - this process is not keeping up with the publisher";
+    d_dropped = 0;
+    d_last_dropped_report = now;
+  }
+}
+
+int iq_bus_source::work(int noutput_items, gr_vector_const_void_star &input_items, gr_vector_void_star &output_items) {
+  gr_complex *out = (gr_complex *)output_items[0];
+
+  if (!d_reader.is_open()) {
+    if (!d_reader.open(d_name)) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      return 0;
+    }
+    BOOST_LOG_TRIVIAL(info) << "IQ Bus " << d_name << ": attached";
+    d_tag_next = true;
+  }
+
+  // Wait up to 100ms for the publisher, so a stopping flow graph is not held up
+  for (int i = 0; i < 100; i++) {
+    uint64_t dropped;
+    size_t n = d_reader.read(out, noutput_items, dropped);
+    if (dropped) {
+      report_dropped(dropped);
+    }
+
+    if (n > 0) {
+      d_last_sample = std::chrono::steady_clock::now();
+
+      // Like a UHD source, the time is tagged on the first sample and again
+      // after any gap
+      uint64_t end = d_reader.get_position();
+      uint64_t sample;
+      int64_t time_ns;
+      if (d_tag_next && d_reader.find_stamp(end - n, end, sample, time_ns)) {
+        pmt::pmt_t rx_time = pmt::make_tuple(pmt::from_uint64(time_ns / 1000000000), pmt::from_double((time_ns % 1000000000) / 1e9));
+        add_item_tag(0, nitems_written(0) + (sample - (end - n)), pmt::intern("rx_time"), rx_time);
+        d_tag_next = false;
+      }
+      return n;
+    }
+
+    reattach_if_restarted();
+    if (!d_reader.is_open()) {
+      return 0;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  return 0;
+}
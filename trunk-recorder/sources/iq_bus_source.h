@@ -0,0 +1,41 @@
+#ifndef IQ_BUS_SOURCE_H
+#define IQ_BUS_SOURCE_H
+
+#include "iq_bus.h"
+#include <chrono>
+#include <gnuradio/io_signature.h>
+#include <gnuradio/sync_block.h>
+
+// Reads the samples another trunk-recorder process publishes on an IQ Bus
+class iq_bus_source : public gr::sync_block {
+private:
+  std::string d_name;
+  Iq_Bus_Reader d_reader;
+  bool d_tag_next;
+  uint64_t d_dropped;
+  std::chrono::steady_clock::time_point d_last_sample;
+  std::chrono::steady_clock::time_point d_last_check;
+  std::chrono::steady_clock::time_point d_last_dropped_report;
+
+  void reattach_if_restarted();
+  void report_dropped(uint64_t dropped);
+
+public:
+#if GNURADIO_VERSION < 0x030900
+  typedef boost::shared_ptr<iq_bus_source> sptr;
+#else
+  typedef std::shared_ptr<iq_bus_source> sptr;
+#endif
+  static sptr make(std::string name);
+
+  iq_bus_source(std::string name);
+
+  bool is_attached() const { return d_reader.is_open(); }
+  double get_center() const { return d_reader.get_center(); }
+  double get_rate() const { return d_reader.get_rate(); }
+  double get_error() const { return d_reader.get_error(); }
+
+  int work(int noutput_items, gr_vector_const_void_star &input_items, gr_vector_void_star &output_items);
+};
+
+#endif
@@ -18,6 +18,8 @@ enum MonitoringState {
              NO_RECORDER = 4,
              ENCRYPTED = 5,
              DUPLICATE = 6,
-             SUPERSEDED = 7};
+             SUPERSEDED = 7,
+             PREEMPTED = 8,
+             OFFLOADED = 9};
 
 #endif
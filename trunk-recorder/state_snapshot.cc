@@ -0,0 +1,250 @@
+#include "state_snapshot.h"
+#include "call.h"
+#include "formatter.h"
+#include "systems/p25_parser.h"
+#include "systems/system_impl.h"
+#include <boost/filesystem.hpp>
+#include <boost/log/trivial.hpp>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <unistd.h>
+
+std::string State_Snapshot::snapshot_file = "";
+int State_Snapshot::snapshot_interval = 10;
+time_t State_Snapshot::last_save = 0;
+nlohmann::json State_Snapshot::restored_freq_tables = nlohmann::json::object();
+std::future<bool> State_Snapshot::writer;
+
+static const int SNAPSHOT_VERSION = 1;
+
+static System_impl *find_system(std::vector<System *> &systems, const std::string &short_name) {
+  for (std::vector<System *>::iterator it = systems.begin(); it != systems.end(); ++it) {
+    if ((*it)->get_short_name() == short_name) {
+      return (System_impl *)*it;
+    }
+  }
+  return NULL;
+}
+
+static bool write_all(int fd, const std::string &data) {
+  size_t written = 0;
+  while (written < data.size()) {
+    ssize_t n = write(fd, data.data() + written, data.size() - written);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    written += n;
+  }
+  return true;
+}
+
+void State_Snapshot::init(Config &config, std::vector<System *> &systems) {
+  snapshot_file = config.state_snapshot_file;
+  snapshot_interval = config.state_snapshot_interval;
+  last_save = time(NULL);
+
+  if (!enabled()) {
+    return;
+  }
+
+  std::ifstream in(snapshot_file);
+  if (!in.is_open()) {
+    BOOST_LOG_TRIVIAL(info) << "State Snapshot: there is no snapshot at " << snapshot_file << " to restore";
+    return;
+  }
+
+  nlohmann::json snapshot = nlohmann::json::parse(in, nullptr, false);
+  if (snapshot.is_discarded() || !snapshot.is_object() || (snapshot.value("version", 0) != SNAPSHOT_VERSION)) {
+    BOOST_LOG_TRIVIAL(error) << "State Snapshot: " << snapshot_file << " can't be read, starting without it";
+    return;
+  }
+
+  try {
+    time_t saved_at = snapshot.value("savedAt", (time_t)0);
+    int restored = 0;
+
+    for (nlohmann::json::iterator it = snapshot["systems"].begin(); it != snapshot["systems"].end(); ++it) {
+      nlohmann::json &s = *it;
+      System_impl *sys = find_system(systems, s.value("shortName", ""));
+      if (!sys) {
+        continue;
+      }
+
+      // A control channel that has since been taken out of the config is ignored
+      if (s.contains("controlChannel") && sys->set_current_control_channel(s["controlChannel"].get<double>())) {
+        BOOST_LOG_TRIVIAL(info) << "[" << sys->get_short_name() << "]\tState Snapshot: starting on control channel " << format_freq(sys->get_current_control_channel());
+      }
+
+      sys->restore_status(s.value("sysId", 0UL), s.value("wacn", 0UL), s.value("nac", 0UL));
+
+      for (nlohmann::json::iterator patch = s["patches"].begin(); patch != s["patches"].end(); ++patch) {
+        unsigned long supergroup = (*patch)[0].get<unsigned long>();
+        for (nlohmann::json::iterator member = (*patch)[1].begin(); member != (*patch)[1].end(); ++member) {
+          sys->talkgroup_patches[supergroup][(*member)[0].get<unsigned long>()] = (*member)[1].get<time_t>();
+        }
+      }
+
+      for (nlohmann::json::iterator activity = s["activity"].begin(); activity != s["activity"].end(); ++activity) {
+        Pretune_Freq f;
+        f.freq = (*activity)[1].get<double>();
+        f.qpsk_mod = (*activity)[2].get<bool>();
+        f.priority = 0;
+        f.last_active = (*activity)[3].get<time_t>();
+        sys->talkgroup_activity[(*activity)[0].get<long>()] = f;
+      }
+
+      // The calls that were being recorded are most likely still going, so
+      // their channels are the first ones worth pre-tuning
+      for (nlohmann::json::iterator call = s["calls"].begin(); call != s["calls"].end(); ++call) {
+        Pretune_Freq &f = sys->talkgroup_activity[(*call)[0].get<long>()];
+        f.freq = (*call)[1].get<double>();
+        f.qpsk_mod = sys->get_qpsk_mod();
+        f.last_active = saved_at;
+      }
+
+      if (s.contains("freqTables")) {
+        restored_freq_tables[sys->get_short_name()] = s["freqTables"];
+      }
+
+      BOOST_LOG_TRIVIAL(info) << "[" << sys->get_short_name() << "]\tState Snapshot: restored " << s["freqTables"].size() << " channel identifiers, " << s["patches"].size() << " patches, " << s["activity"].size() << " active talkgroups and " << s["calls"].size() << " calls in progress";
+      restored++;
+    }
+
+    BOOST_LOG_TRIVIAL(info) << "State Snapshot: restored " << restored << " Systems from a snapshot taken " << (time(NULL) - saved_at) << " seconds ago";
+  } catch (nlohmann::json::exception &e) {
+    BOOST_LOG_TRIVIAL(error) << "State Snapshot: " << snapshot_file << " is damaged, it was only partly restored - " << e.what();
+  }
+}
+
+void State_Snapshot::restore_freq_tables(P25Parser *p25_parser, std::vector<System *> &systems) {
+  for (std::vector<System *>::iterator it = systems.begin(); it != systems.end(); ++it) {
+    System *sys = *it;
+    if (!restored_freq_tables.contains(sys->get_short_name())) {
+      continue;
+    }
+
+    nlohmann::json &tables = restored_freq_tables[sys->get_short_name()];
+    for (nlohmann::json::iterator t = tables.begin(); t != tables.end(); ++t) {
+      Freq_Table table = {
+          (*t)[0].get<unsigned long>(), // id
+          (*t)[1].get<long>(),          // offset
+          (*t)[2].get<unsigned long>(), // step
+          (*t)[3].get<unsigned long>(), // frequency
+          (*t)[4].get<bool>(),          // phase2_tdma
+          (*t)[5].get<int>(),           // slots_per_carrier
+          (*t)[6].get<double>()         // bandwidth
+      };
+      p25_parser->add_freq_table(table.id, table, sys->get_sys_num());
+    }
+  }
+  restored_freq_tables = nlohmann::json::object();
+}
+
+void State_Snapshot::update(std::vector<System *> &systems, std::vector<Call *> &calls, P25Parser *p25_parser) {
+  if (!enabled() || (time(NULL) - last_save < snapshot_interval)) {
+    return;
+  }
+  // Still busy with the last one, so the disk is slow. Tried again next time.
+  if (writer.valid() && (writer.wait_for(std::chrono::seconds(0)) != std::future_status::ready)) {
+    return;
+  }
+  writer = std::async(std::launch::async, write_file, build(systems, calls, p25_parser));
+}
+
+bool State_Snapshot::save(std::vector<System *> &systems, std::vector<Call *> &calls, P25Parser *p25_parser) {
+  if (!enabled()) {
+    return false;
+  }
+  // Otherwise it could finish after this one and put an older snapshot back
+  if (writer.valid()) {
+    writer.wait();
+  }
+  return write_file(build(systems, calls, p25_parser));
+}
+
+std::string State_Snapshot::build(std::vector<System *> &systems, std::vector<Call *> &calls, P25Parser *p25_parser) {
+  last_save = time(NULL);
+
+  nlohmann::json snapshot;
+  snapshot["version"] = SNAPSHOT_VERSION;
+  snapshot["savedAt"] = last_save;
+  snapshot["systems"] = nlohmann::json::array();
+
+  for (std::vector<System *>::iterator it = systems.begin(); it != systems.end(); ++it) {
+    System_impl *sys = (System_impl *)*it;
+    nlohmann::json s;
+    s["shortName"] = sys->get_short_name();
+    if (sys->control_channel_count() > 0) {
+      s["controlChannel"] = sys->get_current_control_channel();
+    }
+    s["sysId"] = sys->get_sys_id();
+    s["wacn"] = sys->get_wacn();
+    s["nac"] = sys->get_nac();
+
+    s["freqTables"] = nlohmann::json::array();
+    if (p25_parser && (sys->get_system_type() == "p25")) {
+      const std::map<int, Freq_Table> &tables = p25_parser->get_freq_tables(sys->get_sys_num());
+      for (std::map<int, Freq_Table>::const_iterator t = tables.begin(); t != tables.end(); ++t) {
+        const Freq_Table &table = t->second;
+        s["freqTables"].push_back({table.id, table.offset, table.step, table.frequency, table.phase2_tdma, table.slots_per_carrier, table.bandwidth});
+      }
+    }
+
+    s["patches"] = nlohmann::json::array();
+    for (std::map<unsigned long, std::map<unsigned long, std::time_t>>::iterator patch = sys->talkgroup_patches.begin(); patch != sys->talkgroup_patches.end(); ++patch) {
+      nlohmann::json members = nlohmann::json::array();
+      for (std::map<unsigned long, std::time_t>::iterator member = patch->second.begin(); member != patch->second.end(); ++member) {
+        members.push_back({member->first, member->second});
+      }
+      s["patches"].push_back({patch->first, members});
+    }
+
+    s["activity"] = nlohmann::json::array();
+    for (std::map<long, Pretune_Freq>::iterator activity = sys->talkgroup_activity.begin(); activity != sys->talkgroup_activity.end(); ++activity) {
+      s["activity"].push_back({activity->first, activity->second.freq, activity->second.qpsk_mod, activity->second.last_active});
+    }
+
+    s["calls"] = nlohmann::json::array();
+    for (std::vector<Call *>::iterator c = calls.begin(); c != calls.end(); ++c) {
+      Call *call = *c;
+      if ((call->get_system() == sys) && (call->get_state() == RECORDING)) {
+        s["calls"].push_back({call->get_talkgroup(), call->get_freq(), call->get_start_time()});
+      }
+    }
+
+    snapshot["systems"].push_back(s);
+  }
+  return snapshot.dump();
+}
+
+bool State_Snapshot::write_file(std::string data) {
+  // Written next to the snapshot and renamed over it, so a crash part way
+  // through never leaves a half written snapshot behind
+  std::string temp_file = snapshot_file + ".tmp";
+  int fd = open(temp_file.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    BOOST_LOG_TRIVIAL(error) << "State Snapshot: unable to create " << temp_file << " - " << strerror(errno);
+    return false;
+  }
+  bool ok = write_all(fd, data) && (fsync(fd) == 0);
+  close(fd);
+  if (!ok || (rename(temp_file.c_str(), snapshot_file.c_str()) != 0)) {
+    BOOST_LOG_TRIVIAL(error) << "State Snapshot: unable to write " << snapshot_file << " - " << strerror(errno);
+    unlink(temp_file.c_str());
+    return false;
+  }
+
+  // Make the rename itself survive a power cut
+  std::string dir = boost::filesystem::path(snapshot_file).parent_path().string();
+  int dir_fd = open(dir.empty() ? "." : dir.c_str(), O_RDONLY);
+  if (dir_fd >= 0) {
+    fsync(dir_fd);
+    close(dir_fd);
+  }
+  return true;
+}
@@ -0,0 +1,59 @@
+#ifndef STATE_SNAPSHOT_H
+#define STATE_SNAPSHOT_H
+
+#include <ctime>
+#include <future>
+#include <string>
+#include <vector>
+
+#include "./global_structs.h"
+
+class Call;
+class P25Parser;
+class System;
+
+/*
+ * Saves what trunk-recorder has learnt from the control channels, so that
+ * after a restart it can record the first grant it decodes instead of
+ * waiting to hear it all again.
+ *
+ * For each System, by shortName, the snapshot keeps the control channel that
+ * was last decoded, the P25 System ID, WACN and NAC, the channel identifier
+ * tables from IDEN_UP messages, the talkgroup patches, the talkgroup activity
+ * used to pre-tune recorders and the calls being recorded. It is written as
+ * compact JSON to a temporary file that is then renamed over the snapshot, so
+ * a crash leaves either the old snapshot or the new one.
+ *
+ * The periodic snapshots are built on the monitor thread and written, synced
+ * and renamed by a worker, so a slow disk never holds up the control
+ * channels. The final one at shutdown is written before returning.
+ *
+ * Anything restored is replaced as soon as the control channel says otherwise.
+ */
+class State_Snapshot {
+
+public:
+  // Reads the snapshot into the Systems. Has to be called before
+  // setup_systems, so the control channels are tuned to the restored ones.
+  static void init(Config &config, std::vector<System *> &systems);
+  static bool enabled() { return !snapshot_file.empty(); }
+
+  // Hands the restored channel identifier tables to the P25 parser
+  static void restore_freq_tables(P25Parser *p25_parser, std::vector<System *> &systems);
+  // Hands a snapshot to a worker to write when one is due
+  static void update(std::vector<System *> &systems, std::vector<Call *> &calls, P25Parser *p25_parser);
+  // Writes a snapshot now, used at shutdown
+  static bool save(std::vector<System *> &systems, std::vector<Call *> &calls, P25Parser *p25_parser);
+
+private:
+  static std::string snapshot_file;
+  static int snapshot_interval;
+  static time_t last_save;
+  static nlohmann::json restored_freq_tables;
+  static std::future<bool> writer;
+
+  static std::string build(std::vector<System *> &systems, std::vector<Call *> &calls, P25Parser *p25_parser);
+  static bool write_file(std::string data);
+};
+
+#endif
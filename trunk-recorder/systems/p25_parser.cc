@@ -72,6 +72,10 @@ void P25Parser::add_freq_table(int freq_table_id, Freq_Table temp_table, int sys
   freq_tables[sys_num][freq_table_id] = temp_table;
 }
 
+const std::map<int, Freq_Table> &P25Parser::get_freq_tables(int sys_num) {
+  return freq_tables[sys_num];
+}
+
 long P25Parser::get_tdma_slot(int chan_id, int sys_num) {
   long channel = chan_id & 0xfff;
 
@@ -41,6 +41,7 @@ public:
   std::string channel_id_to_freq_string(int chan_id, int sys_num);
   void print_bitset(boost::dynamic_bitset<> &tsbk);
   void add_freq_table(int freq_table_id, Freq_Table table, int sys_num);
+  const std::map<int, Freq_Table> &get_freq_tables(int sys_num);
   void load_freq_table(std::string custom_freq_table_file, int sys_num);
   double channel_id_to_frequency(int chan_id, int sys_num);
   std::string channel_to_string(int chan, int sys_num);
@@ -22,6 +22,8 @@
 
 #include <boost/property_tree/ptree.hpp>
 
+#include "../json_writer.h"
+
 class Source;
 class analog_recorder;
 class p25_recorder;
@@ -181,6 +183,8 @@ public:
   virtual int get_autotune_offset() = 0;
   virtual void set_autotune_offset(int offset) = 0;
 
+  virtual void write_stats(Json_Writer &writer) = 0;
+  virtual void write_stats_current(Json_Writer &writer, float timeDiff) = 0;
   virtual boost::property_tree::ptree get_stats() = 0;
   virtual boost::property_tree::ptree get_stats_current(float timeDiff) = 0;
 
@@ -1,4 +1,5 @@
 #include "system_impl.h"
+#include <algorithm>
 #include "system.h"
 
 System *System::make(int sys_num) {
@@ -84,9 +85,11 @@ System_impl::System_impl(int sys_num) {
   nac = 0;
   sys_rfss = 0;
   sys_site_id = 0;
+  status_restored = false;
   current_control_channel = 0;
   xor_mask_len = 0;
   xor_mask = NULL;
+  source = NULL;
   // Setup the talkgroups from the CSV file
   talkgroups = new Talkgroups();
   // Setup the unit tags from the CSV file
@@ -101,6 +104,12 @@ System_impl::System_impl(int sys_num) {
   d_tps_enabled = false;
   retune_attempts = 0;
   message_count = 0;
+  recorder_alloc_count = 0;
+  recorder_alloc_usec = 0;
+  recorder_alloc_max_usec = 0;
+  preemption_count = 0;
+  pretune_hit_count = 0;
+  rejected_grant_count = 0;
   decode_rate = 0;
   msg_queue = gr::msg_queue::make(100);
 }
@@ -123,6 +132,20 @@ void System_impl::set_xor_mask(unsigned long sys_id, unsigned long wacn, unsigne
   }
 }
 bool System_impl::update_status(TrunkMessage message) {
+  // A restored System ID only stands until the control channel sends its own.
+  // It is still the first status for this run, so the plugins are told.
+  if (status_restored) {
+    status_restored = false;
+    if ((message.sys_id == sys_id) && (message.wacn == wacn) && (message.nac == nac)) {
+      BOOST_LOG_TRIVIAL(info) << "[" << short_name << "]\tDecoding System ID "
+                              << std::hex << std::uppercase << message.sys_id << " WACN: "
+                              << std::hex << std::uppercase << message.wacn << " NAC: " << std::hex << std::uppercase << message.nac << ", as restored";
+      return true;
+    }
+    sys_id = 0;
+    wacn = 0;
+    nac = 0;
+  }
   if (!sys_id || !wacn || !nac) {
     sys_id = message.sys_id;
     wacn = message.wacn;
@@ -144,6 +167,17 @@ bool System_impl::update_status(TrunkMessage message) {
   return false;
 }
 
+void System_impl::restore_status(unsigned long sys_id, unsigned long wacn, unsigned long nac) {
+  if (sys_id && wacn && nac) {
+    this->sys_id = sys_id;
+    this->wacn = wacn;
+    this->nac = nac;
+    lfsr = new p25p2_lfsr(nac, sys_id, wacn);
+    xor_mask = lfsr->getXorChars(xor_mask_len);
+    status_restored = true;
+  }
+}
+
 bool System_impl::update_sysid(TrunkMessage message) {
   if (!sys_rfss || !sys_site_id) {
     sys_rfss = message.sys_rfss;
@@ -326,6 +360,24 @@ void System_impl::set_talkgroups_file(std::string talkgroups_file) {
   this->talkgroups->load_talkgroups(sys_num, talkgroups_file);
 }
 
+// Talkgroups of conventional systems come from the channel file, which also
+// sets up the recorders, so only trunked systems reload
+bool System_impl::reload_talkgroups() {
+  if ((system_type != "p25") && (system_type != "smartnet")) {
+    return true;
+  }
+  return this->talkgroups->reload_talkgroups(sys_num, talkgroups_file);
+}
+
+bool System_impl::reload_unit_tags() {
+  return this->unit_tags->reload_unit_tags(unit_tags_file);
+}
+
+void System_impl::free_retired_tables() {
+  this->talkgroups->free_retired_tables();
+  this->unit_tags->free_retired_tables();
+}
+
 void System_impl::set_unit_tags_file(std::string unit_tags_file) {
   BOOST_LOG_TRIVIAL(info) << "Loading Unit Tags...";
   this->unit_tags_file = unit_tags_file;
@@ -382,6 +434,15 @@ void System_impl::set_source(Source *s) {
   this->source = s;
 }
 
+System_impl::Control_Channel_Slot *System_impl::get_control_channel_slot(Source *s) {
+  for (std::vector<Control_Channel_Slot>::iterator it = control_channel_slots.begin(); it != control_channel_slots.end(); it++) {
+    if (it->source == s) {
+      return &(*it);
+    }
+  }
+  return NULL;
+}
+
 Talkgroup *System_impl::find_talkgroup(long tg_number) {
   return talkgroups->find_talkgroup(sys_num, tg_number);
 }
@@ -475,6 +536,82 @@ void System_impl::set_message_count(int count) {
   message_count = count;
 }
 
+void System_impl::add_recorder_alloc_time(double usec) {
+  recorder_alloc_count++;
+  recorder_alloc_usec += usec;
+  if (usec > recorder_alloc_max_usec) {
+    recorder_alloc_max_usec = usec;
+  }
+}
+
+void System_impl::note_talkgroup_grant(long talkgroup, double freq) {
+  Pretune_Freq &activity = talkgroup_activity[talkgroup];
+  activity.freq = freq;
+  activity.qpsk_mod = qpsk_mod;
+  activity.last_active = time(NULL);
+}
+
+void System_impl::note_talkgroup_affiliation(long talkgroup) {
+  std::map<long, Pretune_Freq>::iterator it = talkgroup_activity.find(talkgroup);
+  if (it != talkgroup_activity.end()) {
+    it->second.last_active = time(NULL);
+  }
+}
+
+// Voice channels last granted to talkgroups that have been active within the
+// window, best priority first and then most recently active. Talkgroups that
+// aren't in the talkgroup file, or are analog or not recorded, are left out,
+// as are encrypted ones unless they are being recorded. Stale entries are dropped.
+std::vector<Pretune_Freq> System_impl::get_pretune_freqs(time_t window) {
+  std::vector<Pretune_Freq> freqs;
+  time_t now = time(NULL);
+
+  for (std::map<long, Pretune_Freq>::iterator it = talkgroup_activity.begin(); it != talkgroup_activity.end();) {
+    if ((now - it->second.last_active) > window) {
+      it = talkgroup_activity.erase(it);
+      continue;
+    }
+
+    Talkgroup *tg = find_talkgroup(it->first);
+    bool encrypted = (tg && (tg->mode.compare("E") == 0 || tg->mode.compare("TE") == 0 || tg->mode.compare("DE") == 0));
+    if (tg && (tg->get_priority() >= 1) && (tg->mode.compare("A") != 0) && (!encrypted || get_monitorEncrypted())) {
+      Pretune_Freq f = it->second;
+      f.priority = tg->get_priority();
+      freqs.push_back(f);
+    }
+    it++;
+  }
+
+  std::sort(freqs.begin(), freqs.end(), [](const Pretune_Freq &a, const Pretune_Freq &b) {
+    if (a.priority != b.priority) {
+      return a.priority < b.priority;
+    }
+    return a.last_active > b.last_active;
+  });
+  return freqs;
+}
+
+int System_impl::get_encrypted_talkgroup_count() {
+  int count = 0;
+  for (std::map<long, Rejected_Talkgroup>::iterator it = rejected_talkgroups.begin(); it != rejected_talkgroups.end(); it++) {
+    if (it->second.encrypted) {
+      count++;
+    }
+  }
+  return count;
+}
+
+void System_impl::prune_rejected_talkgroups(time_t max_age) {
+  time_t now = time(NULL);
+  for (std::map<long, Rejected_Talkgroup>::iterator it = rejected_talkgroups.begin(); it != rejected_talkgroups.end();) {
+    if ((now - it->second.last_seen) > max_age) {
+      it = rejected_talkgroups.erase(it);
+    } else {
+      it++;
+    }
+  }
+}
+
 void System_impl::set_decode_rate(int rate) {
   decode_rate = rate;
 }
@@ -498,6 +635,16 @@ double System_impl::get_current_control_channel() {
   return this->control_channels[current_control_channel];
 }
 
+bool System_impl::set_current_control_channel(double control_channel) {
+  for (unsigned int i = 0; i < control_channels.size(); i++) {
+    if (control_channels[i] == control_channel) {
+      current_control_channel = i;
+      return true;
+    }
+  }
+  return false;
+}
+
 double System_impl::get_next_control_channel() {
   current_control_channel++;
   if (current_control_channel >= control_channels.size()) {
@@ -625,24 +772,41 @@ void System_impl::set_autotune_offset(int offset) {
   }
 }
 
-boost::property_tree::ptree System_impl::get_stats() {
-  boost::property_tree::ptree system_node;
-  system_node.put("id", this->get_sys_num());
-  system_node.put("name", this->get_short_name());
-  system_node.put("type", this->get_system_type());
-  system_node.put("sysid", this->get_sys_id());
-  system_node.put("wacn", this->get_wacn());
-  system_node.put("nac", this->get_nac());
+void System_impl::write_stats(Json_Writer &writer) {
+  writer.begin_object();
+  writer.put("id", this->get_sys_num());
+  writer.put("name", this->get_short_name());
+  writer.put("type", this->get_system_type());
+  writer.put("sysid", this->get_sys_id());
+  writer.put("wacn", this->get_wacn());
+  writer.put("nac", this->get_nac());
+  writer.end_object();
+}
 
-  return system_node;
+void System_impl::write_stats_current(Json_Writer &writer, float timeDiff) {
+  writer.begin_object();
+  writer.put("id", this->get_sys_num());
+  writer.put("decoderate", this->message_count / timeDiff);
+  writer.put("allocations", this->recorder_alloc_count);
+  writer.put("allocLatencyAvg", recorder_alloc_count ? recorder_alloc_usec / recorder_alloc_count : 0);
+  writer.put("allocLatencyMax", recorder_alloc_max_usec);
+  writer.put("preemptions", this->preemption_count);
+  writer.put("pretuneHits", this->pretune_hit_count);
+  writer.put("grantsRejected", this->rejected_grant_count);
+  writer.put("encryptedTalkgroups", this->get_encrypted_talkgroup_count());
+  writer.end_object();
 }
 
-boost::property_tree::ptree System_impl::get_stats_current(float timeDiff) {
-  boost::property_tree::ptree system_node;
-  system_node.put("id", this->get_sys_num());
-  system_node.put("decoderate", this->message_count / timeDiff);
+boost::property_tree::ptree System_impl::get_stats() {
+  Json_Writer writer;
+  write_stats(writer);
+  return writer.to_ptree();
+}
 
-  return system_node;
+boost::property_tree::ptree System_impl::get_stats_current(float timeDiff) {
+  Json_Writer writer;
+  write_stats_current(writer, timeDiff);
+  return writer.to_ptree();
 }
 
 std::vector<unsigned long> System_impl::get_talkgroup_patch(unsigned long talkgroup) {
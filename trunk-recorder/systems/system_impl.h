@@ -4,6 +4,7 @@
 #include "../unit_tags.h"
 #include <boost/foreach.hpp>
 #include <boost/log/trivial.hpp>
+#include <map>
 #include <stdio.h>
 //#include "../source.h"
 #include "p25_trunking.h"
@@ -50,6 +51,8 @@ class System_impl : public System {
   unsigned long nac;
   int sys_rfss;
   int sys_site_id;
+  // the System ID came from a state snapshot and the control channel has not sent its own yet
+  bool status_restored;
 
 public:
   Talkgroups *talkgroups;
@@ -72,6 +75,20 @@ public:
   int message_count;
   int decode_rate;
   int retune_attempts;
+  // recorder allocation time for grants since the last rate check
+  int recorder_alloc_count;
+  double recorder_alloc_usec;
+  double recorder_alloc_max_usec;
+  // recordings stopped to free a recorder for a higher priority grant
+  int preemption_count;
+  // grants that were handed a recorder already tuned to their freq
+  int pretune_hit_count;
+  // last voice channel granted to each talkgroup and when it was last active
+  std::map<long, Pretune_Freq> talkgroup_activity;
+  // grants turned away before a Call was made for them, since the last rate check
+  int rejected_grant_count;
+  // talkgroups whose grants are being turned away, including those seen encrypted
+  std::map<long, Rejected_Talkgroup> rejected_talkgroups;
   time_t last_message_time;
   std::string bandplan;
   int bandfreq;
@@ -106,8 +123,19 @@ public:
   bool record_unknown;
   bool call_log;
 
+  // A control channel decoder fed from one Source's selector port. One is
+  // built for every Source that covers a control channel so a retune to a
+  // channel on another Source only has to flip selector ports.
+  struct Control_Channel_Slot {
+    Source *source;
+    int selector_port;
+    smartnet_trunking_sptr smartnet_trunking;
+    p25_trunking_sptr p25_trunking;
+  };
+
   smartnet_trunking_sptr smartnet_trunking;
   p25_trunking_sptr p25_trunking;
+  std::vector<Control_Channel_Slot> control_channel_slots;
 
   std::map<unsigned long, std::map<unsigned long, std::time_t>> talkgroup_patches;
 
@@ -173,6 +201,7 @@ public:
   void set_xor_mask(unsigned long sys_id, unsigned long wacn, unsigned long nac) override;
   const char *get_xor_mask() override;
   bool update_status(TrunkMessage message) override;
+  void restore_status(unsigned long sys_id, unsigned long wacn, unsigned long nac);
   bool update_sysid(TrunkMessage message) override;
   int get_sys_num() override;
   void set_system_type(std::string) override;
@@ -180,6 +209,7 @@ public:
   std::string get_unit_tags_file() override;
   Source *get_source() override;
   void set_source(Source *) override;
+  Control_Channel_Slot *get_control_channel_slot(Source *source);
   Talkgroup *find_talkgroup(long tg) override;
   Talkgroup *find_talkgroup_by_freq(double freq) override;
   std::string find_unit_tag(long unitID) override;
@@ -197,11 +227,21 @@ public:
   int control_channel_count() override;
   int get_message_count() override;
   void set_message_count(int count) override;
+  void add_recorder_alloc_time(double usec);
+  bool reload_talkgroups();
+  bool reload_unit_tags();
+  void free_retired_tables();
+  void note_talkgroup_grant(long talkgroup, double freq);
+  void note_talkgroup_affiliation(long talkgroup);
+  std::vector<Pretune_Freq> get_pretune_freqs(time_t window);
+  int get_encrypted_talkgroup_count();
+  void prune_rejected_talkgroups(time_t max_age);
   int get_decode_rate() override;
   void set_decode_rate(int rate) override;
   void add_control_channel(double channel) override;
   double get_next_control_channel() override;
   double get_current_control_channel() override;
+  bool set_current_control_channel(double control_channel);
   int channel_count() override;
   void add_channel(double channel) override;
   void add_conventional_recorder(analog_recorder_sptr rec) override;
@@ -247,6 +287,8 @@ public:
   int get_autotune_offset() override;
   void set_autotune_offset(int offset) override;
 
+  void write_stats(Json_Writer &writer) override;
+  void write_stats_current(Json_Writer &writer, float timeDiff) override;
   boost::property_tree::ptree get_stats() override;
   boost::property_tree::ptree get_stats_current(float timeDiff) override;
 
@@ -14,7 +14,9 @@
 #include <fstream>
 #include <iostream>
 
-Talkgroups::Talkgroups() {}
+Talkgroups::Talkgroups() {
+  table = new Talkgroup_Table();
+}
 
 using namespace csv;
 
@@ -25,19 +27,102 @@ void Talkgroups::load_talkgroups(int sys_num, std::string filename) {
     BOOST_LOG_TRIVIAL(info) << "Reading Talkgroup CSV File: " << filename;
   }
 
+  std::vector<Talkgroup *> rows;
+  if (!read_talkgroups(sys_num, filename, rows)) {
+    exit(0);
+  }
+  publish(rows, false);
+
+  BOOST_LOG_TRIVIAL(info) << "Read " << rows.size() << " talkgroups.";
+}
+
+// Reads the file again and swaps the new list in. If the file can't be read
+// or has errors, the current list is kept.
+bool Talkgroups::reload_talkgroups(int sys_num, std::string filename) {
+  if (filename == "") {
+    return true;
+  }
+  BOOST_LOG_TRIVIAL(info) << "Reloading Talkgroup CSV File: " << filename;
+
+  std::vector<Talkgroup *> rows;
+  bool ok = false;
+  try {
+    ok = read_talkgroups(sys_num, filename, rows);
+  } catch (std::exception &e) {
+    BOOST_LOG_TRIVIAL(error) << "Error reading Talkgroup File: " << filename << " - " << e.what();
+  }
+
+  if (!ok) {
+    for (std::vector<Talkgroup *>::iterator it = rows.begin(); it != rows.end(); ++it) {
+      delete *it;
+    }
+    BOOST_LOG_TRIVIAL(error) << "Keeping the current talkgroups";
+    return false;
+  }
+
+  publish(rows, true);
+  BOOST_LOG_TRIVIAL(info) << "Reloaded " << rows.size() << " talkgroups.";
+  return true;
+}
+
+void Talkgroups::publish(std::vector<Talkgroup *> rows, bool replace) {
+  std::lock_guard<std::mutex> lock(update_mutex);
+  Talkgroup_Table *current = table.load();
+  Talkgroup_Table *next = new Talkgroup_Table();
+
+  if (!replace) {
+    next->talkgroups = current->talkgroups;
+  }
+  next->talkgroups.insert(next->talkgroups.end(), rows.begin(), rows.end());
+
+  // The first entry for a number wins, the same as a search down the list would
+  for (std::vector<Talkgroup *>::iterator it = next->talkgroups.begin(); it != next->talkgroups.end(); ++it) {
+    next->by_number.emplace((*it)->number, *it);
+  }
+
+  table.store(next);
+
+  // A replaced table's Talkgroups are only in older tables from here on
+  Retired_Talkgroup_Table old;
+  old.table = current;
+  if (replace) {
+    old.dropped = current->talkgroups;
+  }
+  old.retired_at = time(NULL);
+  retired.push_back(old);
+}
+
+void Talkgroups::free_retired_tables() {
+  std::lock_guard<std::mutex> lock(update_mutex);
+  time_t now = time(NULL);
+
+  for (std::vector<Retired_Talkgroup_Table>::iterator it = retired.begin(); it != retired.end();) {
+    if (now - it->retired_at < RETIRED_TABLE_SECONDS) {
+      ++it;
+      continue;
+    }
+    for (std::vector<Talkgroup *>::iterator tg = it->dropped.begin(); tg != it->dropped.end(); ++tg) {
+      delete *tg;
+    }
+    delete it->table;
+    it = retired.erase(it);
+  }
+}
+
+bool Talkgroups::read_talkgroups(int sys_num, std::string filename, std::vector<Talkgroup *> &rows) {
   CSVFormat format;
   format.trim({' ', '\t'});
   CSVReader reader(filename, format);
   std::vector<std::string> headers = reader.get_col_names();
   std::vector<std::string> defined_headers = {"Decimal", "Mode", "Description", "Alpha Tag", "Hex", "Category", "Tag", "Priority", "Preferred NAC", "Comment"};
 
-  if (headers[0] != "Decimal") {
+  if (headers.empty() || (headers[0] != "Decimal")) {
 
     BOOST_LOG_TRIVIAL(error) << "Column Headers are required for Talkgroup CSV files";
     BOOST_LOG_TRIVIAL(error) << "The first column must be 'Decimal'";
     BOOST_LOG_TRIVIAL(error) << "Required columns are: 'Decimal', 'Mode', 'Description'";
     BOOST_LOG_TRIVIAL(error) << "Optional columns are: 'Alpha Tag', 'Hex', 'Category', 'Tag', 'Priority', 'Preferred NAC'";
-    exit(0);
+    return false;
   } else {
     BOOST_LOG_TRIVIAL(info) << "Found Columns: " << internals::format_row(reader.get_col_names(), ", ");
   }
@@ -47,11 +132,10 @@ void Talkgroups::load_talkgroups(int sys_num, std::string filename) {
       BOOST_LOG_TRIVIAL(error) << "Unknown column header: " << headers[i];
       BOOST_LOG_TRIVIAL(error) << "Required columns are: 'Decimal', 'Mode', 'Description'";
       BOOST_LOG_TRIVIAL(error) << "Optional columns are: 'Alpha Tag', 'Hex', 'Category', 'Tag', 'Priority', 'Preferred NAC'";
-      exit(0);
+      return false;
     }
   }
 
-  long lines_pushed = 0;
   for (CSVRow &row : reader) { // Input iterator
     Talkgroup *tg = NULL;
     int priority = 1;
@@ -67,23 +151,21 @@ void Talkgroups::load_talkgroups(int sys_num, std::string filename) {
       tg_number = row["Decimal"].get<long>();
     } else {
       BOOST_LOG_TRIVIAL(error) << "'Decimal' is required for specifying the Talkgroup number - Row: " << reader.n_rows();
-      exit(0);
+      return false;
     }
 
     if ((reader.index_of("Mode") >= 0) && row["Mode"].is_str()) {
       mode = row["Mode"].get<std::string>();
     } else {
       BOOST_LOG_TRIVIAL(error) << "Mode is required for Row: " << reader.n_rows();
-      ;
-      exit(0);
+      return false;
     }
 
     if (reader.index_of("Description") >= 0) {
       description = row["Description"].get<std::string>();
     } else {
       BOOST_LOG_TRIVIAL(error) << "Description is required for Row: " << reader.n_rows();
-      ;
-      exit(0);
+      return false;
     }
 
     if (reader.index_of("Alpha Tag") >= 0) {
@@ -106,11 +188,10 @@ void Talkgroups::load_talkgroups(int sys_num, std::string filename) {
       preferredNAC = row["Preferred NAC"].get<unsigned long>();
     }
     tg = new Talkgroup(sys_num, tg_number, mode, alpha_tag, description, tag, group, priority, preferredNAC);
-    talkgroups.push_back(tg);
-    lines_pushed++;
+    rows.push_back(tg);
   }
 
-  BOOST_LOG_TRIVIAL(info) << "Read " << lines_pushed << " talkgroups.";
+  return true;
 }
 
 void Talkgroups::load_channels(int sys_num, std::string filename) {
@@ -147,6 +228,7 @@ void Talkgroups::load_channels(int sys_num, std::string filename) {
     }
   }
 
+  std::vector<Talkgroup *> channels;
   long lines_pushed = 0;
   for (CSVRow &row : reader) { // Input iterator
     Talkgroup *tg = NULL;
@@ -214,32 +296,30 @@ void Talkgroups::load_channels(int sys_num, std::string filename) {
     }
     if (enable) {
       tg = new Talkgroup(sys_num, tg_number, freq, tone, alpha_tag, description, tag, group, squelch_db, signal_detector);
-      talkgroups.push_back(tg);
+      channels.push_back(tg);
       lines_pushed++;
     }
 
     BOOST_LOG_TRIVIAL(info) << "Read " << lines_pushed << " channels.";
   }
+  publish(channels, false);
 }
 
 Talkgroup *Talkgroups::find_talkgroup(int sys_num, long tg_number) {
-  Talkgroup *tg_match = NULL;
-
-  for (std::vector<Talkgroup *>::iterator it = talkgroups.begin(); it != talkgroups.end(); ++it) {
-    Talkgroup *tg = (Talkgroup *)*it;
+  Talkgroup_Table *current = table.load();
+  std::unordered_map<long, Talkgroup *>::const_iterator it = current->by_number.find(tg_number);
 
-    if ((tg->sys_num == sys_num) && (tg->number == tg_number)) {
-      tg_match = tg;
-      break;
-    }
+  if ((it != current->by_number.end()) && (it->second->sys_num == sys_num)) {
+    return it->second;
   }
-  return tg_match;
+  return NULL;
 }
 
 Talkgroup *Talkgroups::find_talkgroup_by_freq(int sys_num, double freq) {
+  Talkgroup_Table *current = table.load();
   Talkgroup *tg_match = NULL;
 
-  for (std::vector<Talkgroup *>::iterator it = talkgroups.begin(); it != talkgroups.end(); ++it) {
+  for (std::vector<Talkgroup *>::iterator it = current->talkgroups.begin(); it != current->talkgroups.end(); ++it) {
     Talkgroup *tg = (Talkgroup *)*it;
 
     if ((tg->sys_num == sys_num) && (tg->freq == freq)) {
@@ -251,5 +331,5 @@ Talkgroup *Talkgroups::find_talkgroup_by_freq(int sys_num, double freq) {
 }
 
 std::vector<Talkgroup *> Talkgroups::get_talkgroups() {
-  return talkgroups;
+  return table.load()->talkgroups;
 }
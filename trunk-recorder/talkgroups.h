@@ -2,19 +2,50 @@
 #define TALKGROUPS_H
 
 #include "talkgroup.h"
+#include <atomic>
 #include <boost/algorithm/string.hpp>
+#include <ctime>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
-class Talkgroups {
+// A snapshot of the talkgroup list. It is never changed once published;
+// loading or reloading a file builds a new table and swaps it in.
+struct Talkgroup_Table {
   std::vector<Talkgroup *> talkgroups;
+  std::unordered_map<long, Talkgroup *> by_number;
+};
+
+// Lookups only hold on to a Talkgroup for as long as they take to copy its
+// fields, so a table that was swapped out this long ago is no longer in use
+#define RETIRED_TABLE_SECONDS 60
+
+// A table that has been swapped out, with the Talkgroups no newer table has
+struct Retired_Talkgroup_Table {
+  Talkgroup_Table *table;
+  std::vector<Talkgroup *> dropped;
+  time_t retired_at;
+};
+
+class Talkgroups {
+  std::atomic<Talkgroup_Table *> table;
+  // Tables that have been swapped out. Lookups on other threads may still be
+  // using them, so they are freed RETIRED_TABLE_SECONDS later.
+  std::vector<Retired_Talkgroup_Table> retired;
+  std::mutex update_mutex;
+
+  bool read_talkgroups(int sys_num, std::string filename, std::vector<Talkgroup *> &rows);
+  void publish(std::vector<Talkgroup *> rows, bool replace);
 
 public:
   Talkgroups();
   void load_talkgroups(int sys_num, std::string filename);
+  bool reload_talkgroups(int sys_num, std::string filename);
   void load_channels(int sys_num, std::string filename);
   Talkgroup *find_talkgroup(int sys_num, long tg);
   Talkgroup *find_talkgroup_by_freq(int sys_num, double freq);
   std::vector<Talkgroup *> get_talkgroups();
+  void free_retired_tables();
 };
 #endif // TALKGROUPS_H
@@ -16,11 +16,55 @@
 
 using namespace csv;
 
+static UnitTag *make_unit_tag(std::string pattern, std::string tag) {
+  // If the pattern is like /someregex/
+  if (pattern.substr(0, 1).compare("/") == 0 && pattern.substr(pattern.length()-1, 1).compare("/") == 0) {
+    // then remove the / at the beginning and end
+    pattern = pattern.substr(1, pattern.length()-2);
+  } else {
+    // otherwise add ^ and $ to the pattern e.g. ^123$ to make a regex for simple IDs
+    pattern = "^" + pattern + "$";
+  }
+  return new UnitTag(pattern, tag);
+}
+
 void UnitTags::load_unit_tags(std::string filename) {
   if (filename == "") {
     return;
   }
 
+  // Rows read before an error are kept
+  std::vector<UnitTag *> rows;
+  bool ok = read_unit_tags(filename, rows);
+  publish(rows, false);
+  if (ok) {
+    BOOST_LOG_TRIVIAL(info) << "Read " << rows.size() << " unit tags.";
+  }
+}
+
+// Reads the file again and swaps the new tags in. If the file can't be read,
+// the current tags are kept. OTA tags are not touched.
+bool UnitTags::reload_unit_tags(std::string filename) {
+  if (filename == "") {
+    return true;
+  }
+  BOOST_LOG_TRIVIAL(info) << "Reloading Unit Tag File: " << filename;
+
+  std::vector<UnitTag *> rows;
+  if (!read_unit_tags(filename, rows)) {
+    for (std::vector<UnitTag *>::iterator it = rows.begin(); it != rows.end(); ++it) {
+      delete *it;
+    }
+    BOOST_LOG_TRIVIAL(error) << "Keeping the current unit tags";
+    return false;
+  }
+
+  publish(rows, true);
+  BOOST_LOG_TRIVIAL(info) << "Reloaded " << rows.size() << " unit tags.";
+  return true;
+}
+
+bool UnitTags::read_unit_tags(std::string filename, std::vector<UnitTag *> &rows) {
   CSVFormat format;
   format.trim({' ', '\t'});
   format.header_row(-1);  // No header row expected
@@ -29,7 +73,6 @@ void UnitTags::load_unit_tags(std::string filename) {
   try {
     CSVReader reader(filename, format);
     
-    int lines_loaded = 0;
     for (CSVRow &row : reader) {
       if (row.size() < 2) {
         continue;
@@ -38,13 +81,50 @@ void UnitTags::load_unit_tags(std::string filename) {
       std::string pattern = row["unit_id"].get<>();
       std::string tag = row["tag"].get<>();
       
-      add(pattern, tag);
-      lines_loaded++;
+      rows.push_back(make_unit_tag(pattern, tag));
     }
-    
-    BOOST_LOG_TRIVIAL(info) << "Read " << lines_loaded << " unit tags.";
   } catch (std::exception &e) {
     BOOST_LOG_TRIVIAL(error) << "Error reading Unit Tag File: " << filename << " - " << e.what();
+    return false;
+  }
+  return true;
+}
+
+void UnitTags::publish(std::vector<UnitTag *> rows, bool replace) {
+  std::lock_guard<std::mutex> lock(update_mutex);
+  std::vector<UnitTag *> *current = unit_tags.load();
+  std::vector<UnitTag *> *next = new std::vector<UnitTag *>();
+
+  if (!replace) {
+    *next = *current;
+  }
+  next->insert(next->end(), rows.begin(), rows.end());
+
+  unit_tags.store(next);
+
+  Retired_Unit_Tags old;
+  old.unit_tags = current;
+  if (replace) {
+    old.dropped = *current;
+  }
+  old.retired_at = time(NULL);
+  retired_unit_tags.push_back(old);
+}
+
+void UnitTags::free_retired_tables() {
+  std::lock_guard<std::mutex> lock(update_mutex);
+  time_t now = time(NULL);
+
+  for (std::vector<Retired_Unit_Tags>::iterator it = retired_unit_tags.begin(); it != retired_unit_tags.end();) {
+    if (now - it->retired_at < RETIRED_UNIT_TAGS_SECONDS) {
+      ++it;
+      continue;
+    }
+    for (std::vector<UnitTag *>::iterator tag = it->dropped.begin(); tag != it->dropped.end(); ++tag) {
+      delete *tag;
+    }
+    delete it->unit_tags;
+    it = retired_unit_tags.erase(it);
   }
 }
 
@@ -198,10 +278,11 @@ std::string UnitTags::find_unit_tag(long tg_number) {
   }
 
   std::string tg_num_str = std::to_string(tg_number);
+  std::vector<UnitTag *> *user_tags = unit_tags.load();
   
   // Helper lambda: Search user tags
   auto search_user_tags = [&]() -> std::string {
-    for (std::vector<UnitTag *>::iterator it = unit_tags.begin(); it != unit_tags.end(); ++it) {
+    for (std::vector<UnitTag *>::iterator it = user_tags->begin(); it != user_tags->end(); ++it) {
       UnitTag *tg = (UnitTag *)*it;
       if (regex_match(tg_num_str, tg->pattern)) {
         return regex_replace(tg_num_str, tg->pattern, tg->tag, boost::regex_constants::format_no_copy | boost::regex_constants::format_all);
@@ -244,16 +325,7 @@ std::string UnitTags::find_unit_tag(long tg_number) {
 }
 
 void UnitTags::add(std::string pattern, std::string tag) {
-  // If the pattern is like /someregex/
-  if (pattern.substr(0, 1).compare("/") == 0 && pattern.substr(pattern.length()-1, 1).compare("/") == 0) {
-    // then remove the / at the beginning and end
-    pattern = pattern.substr(1, pattern.length()-2);
-  } else {
-    // otherwise add ^ and $ to the pattern e.g. ^123$ to make a regex for simple IDs
-    pattern = "^" + pattern + "$";
-  }
-  UnitTag *unit_tag = new UnitTag(pattern, tag);
-  unit_tags.push_back(unit_tag);
+  publish({make_unit_tag(pattern, tag)}, false);
 }
 
 bool UnitTags::add_ota(const OTAAlias& ota_alias) {
@@ -346,7 +418,7 @@ UnitTagMode UnitTags::get_mode() {
 }
 
 std::vector<UnitTag *> UnitTags::get_unit_tags() {
-  return unit_tags;
+  return *unit_tags.load();
 }
 
 std::vector<UnitTagOTA *> UnitTags::get_unit_tags_ota() {
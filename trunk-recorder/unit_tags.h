@@ -4,6 +4,9 @@
 #include "unit_tag.h"
 #include "unit_tags_ota.h"
 
+#include <atomic>
+#include <ctime>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -14,14 +17,34 @@ enum UnitTagMode {
   TAG_NONE = -1       // Don't search any tags
 };
 
+// How long a swapped out list is kept for lookups that may still be using it
+#define RETIRED_UNIT_TAGS_SECONDS 60
+
+// A list that has been swapped out, with the tags no newer list has
+struct Retired_Unit_Tags {
+  std::vector<UnitTag *> *unit_tags;
+  std::vector<UnitTag *> dropped;
+  time_t retired_at;
+};
+
 class UnitTags {
-  std::vector<UnitTag *> unit_tags;                  // Manual tags from unitTagsFile (regex patterns)
+  // Manual tags from unitTagsFile (regex patterns). The list is never changed
+  // once published; add() and reloads swap in a new one. Lookups on other
+  // threads may still be using a swapped out list, so it is freed
+  // RETIRED_UNIT_TAGS_SECONDS later.
+  std::atomic<std::vector<UnitTag *> *> unit_tags{new std::vector<UnitTag *>()};
+  std::vector<Retired_Unit_Tags> retired_unit_tags;
+  std::mutex update_mutex;
   std::vector<UnitTagOTA *> unit_tags_ota;           // OTA tags: simple (unitID, alias) pairs
   std::string ota_filename;
   UnitTagMode mode = TAG_USER_FIRST;                 // Default to user tags first
 
+  bool read_unit_tags(std::string filename, std::vector<UnitTag *> &rows);
+  void publish(std::vector<UnitTag *> rows, bool replace);
+
 public:
   void load_unit_tags(std::string filename);
+  bool reload_unit_tags(std::string filename);
   void load_unit_tags_ota(std::string filename);
   std::string find_unit_tag(long unitID);
   void add(std::string pattern, std::string tag);
@@ -30,5 +53,6 @@ public:
   UnitTagMode get_mode();
   std::vector<UnitTag *> get_unit_tags();
   std::vector<UnitTagOTA *> get_unit_tags_ota();
+  void free_retired_tables();
 };
 #endif // UNIT_TAGS_H
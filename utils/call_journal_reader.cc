@@ -0,0 +1,56 @@
+// Prints the calls in Call Journal files as the call JSON Trunk Recorder
+// writes for each call.
+//
+// Usage: call-journal-reader [--ndjson] calls-YYYYMMDD.trj ...
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include "../trunk-recorder/call_concluder/call_journal.h"
+
+int main(int argc, char **argv) {
+  bool ndjson = false;
+  int files = 0;
+  int status = 0;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--ndjson") == 0) {
+      ndjson = true;
+      continue;
+    }
+    if ((strcmp(argv[i], "--help") == 0) || (strcmp(argv[i], "-h") == 0)) {
+      std::cout << "Usage: call-journal-reader [--ndjson] journal ..." << std::endl;
+      std::cout << "  --ndjson  one call per line, instead of indented JSON" << std::endl;
+      return 0;
+    }
+
+    files++;
+    std::ifstream in(argv[i], std::ios::binary);
+    if (!in.is_open() || !Call_Journal::read_header(in)) {
+      std::cerr << argv[i] << ": not a Call Journal" << std::endl;
+      status = 1;
+      continue;
+    }
+
+    Call_Data_t call_info = {};
+    long count = 0;
+    while (Call_Journal::read_record(in, call_info)) {
+      std::cout << Call_Journal::to_json(call_info).dump(ndjson ? -1 : 2) << std::endl;
+      count++;
+    }
+
+    // Running out of file part way through a record is a record that was
+    // still being written. Anything else is damage.
+    if (!in.eof()) {
+      std::cerr << argv[i] << ": stopped at a damaged record after " << count << " calls" << std::endl;
+      status = 1;
+    }
+  }
+
+  if (files == 0) {
+    std::cerr << "Usage: call-journal-reader [--ndjson] journal ..." << std::endl;
+    return 1;
+  }
+  return status;
+}